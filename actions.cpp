@@ -0,0 +1,189 @@
+#include "toplevel.hpp"
+
+#include "actions.hpp"
+#include "utils.hpp"
+
+struct yawc_toplevel *focused_toplevel(struct yawc_server *server){
+    if(wl_list_empty(&server->toplevels)){
+        return nullptr;
+    }
+
+    //focusing moves a toplevel to the front
+    struct yawc_toplevel *toplevel = wl_container_of(server->toplevels.next, toplevel, link);
+
+    if(!toplevel->mapped || toplevel->hidden){
+        return nullptr;
+    }
+
+    return toplevel;
+}
+
+bool focusable(struct yawc_toplevel *toplevel){
+    return toplevel->mapped && !toplevel->hidden;
+}
+
+void focus_next(struct yawc_server *server){
+    //the least recently focused one, repeating cycles through all of them
+    struct yawc_toplevel *toplevel;
+    wl_list_for_each_reverse(toplevel, &server->toplevels, link){
+        if(focusable(toplevel)){
+            if(toplevel != focused_toplevel(server)){
+                toplevel->request_activate();
+            }
+
+            return;
+        }
+    }
+}
+
+void focus_prev(struct yawc_server *server){
+    //the one focused before the current one
+    auto *current = focused_toplevel(server);
+
+    struct yawc_toplevel *toplevel;
+    wl_list_for_each(toplevel, &server->toplevels, link){
+        if(toplevel != current && focusable(toplevel)){
+            toplevel->request_activate();
+            return;
+        }
+    }
+}
+
+struct yawc_output *find_target_output(struct yawc_server *server, struct yawc_output *current, const std::string &name){
+    auto usable = [server](struct yawc_output *output){
+        return output != server->fallback_output && !output->mirror_source
+            && wlr_output_layout_get(server->output_layout, output->wlr_output);
+    };
+
+    struct yawc_output *output;
+
+    if(!name.empty() && name != "next"){
+        wl_list_for_each(output, &server->outputs, link){
+            if(name == output->wlr_output->name && usable(output)){
+                return output;
+            }
+        }
+
+        return nullptr;
+    }
+
+    //the next one after current, wrapping around
+    bool passed = !current;
+    struct yawc_output *first = nullptr;
+
+    wl_list_for_each(output, &server->outputs, link){
+        if(output == current){
+            passed = true;
+            continue;
+        }
+
+        if(!usable(output)){
+            continue;
+        }
+
+        if(passed){
+            return output;
+        }
+
+        if(!first){
+            first = output;
+        }
+    }
+
+    return first;
+}
+
+void move_to_output(struct yawc_server *server, const std::string &name){
+    auto *toplevel = focused_toplevel(server);
+
+    if(!toplevel){
+        return;
+    }
+
+    auto *current = utils::get_output_of_toplevel(toplevel);
+    auto *target = find_target_output(server, current, name);
+
+    if(!target || target == current){
+        return;
+    }
+
+    struct wlr_box from = {}, to;
+    if(current){
+        wlr_output_layout_get_box(server->output_layout, current->wlr_output, &from);
+    }
+    wlr_output_layout_get_box(server->output_layout, target->wlr_output, &to);
+
+    int dx = to.x - from.x, dy = to.y - from.y;
+
+    //the geometry it goes back to has to land on the new output too
+    toplevel->last_geo.x += dx;
+    toplevel->last_geo.y += dy;
+
+    if(toplevel->fullscreen){
+        wlr_scene_node_set_position(&toplevel->scene_tree->node, to.x, to.y);
+        wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, to.width, to.height);
+    } else if(toplevel->maximized){
+        struct wlr_box usable_box = utils::get_usable_area_of_output(target);
+
+        wlr_scene_node_set_position(&toplevel->scene_tree->node, usable_box.x, usable_box.y);
+        wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, usable_box.width, usable_box.height);
+    } else{
+        int x, y;
+        wlr_scene_node_coords(&toplevel->scene_tree->node, &x, &y);
+
+        wlr_scene_node_set_position(&toplevel->scene_tree->node, x + dx, y + dy);
+    }
+
+    hit_index_update(server, &toplevel->scene_tree->node);
+
+    toplevel->send_geometry_update();
+
+    utils::update_output_occupants(server);
+}
+
+void run_builtin_action(struct yawc_server *server, enum yawc_builtin_action action, const std::string &arg){
+    auto *toplevel = focused_toplevel(server);
+
+    switch(action){
+        case YAWC_ACTION_NONE:
+            break;
+        case YAWC_ACTION_SPAWN:
+            utils::exec(arg.c_str());
+            break;
+        case YAWC_ACTION_CLOSE:
+            if(toplevel){
+                toplevel->request_close();
+            }
+            break;
+        case YAWC_ACTION_FULLSCREEN:
+            if(toplevel){
+                toplevel->request_fullscreen(!toplevel->fullscreen);
+            }
+            break;
+        case YAWC_ACTION_MAXIMIZE:
+            if(toplevel){
+                toplevel->request_maximize(!toplevel->maximized);
+            }
+            break;
+        case YAWC_ACTION_MINIMIZE:
+            if(toplevel){
+                toplevel->request_minimize(true);
+            }
+            break;
+        case YAWC_ACTION_FOCUS_NEXT:
+            focus_next(server);
+            break;
+        case YAWC_ACTION_FOCUS_PREV:
+            focus_prev(server);
+            break;
+        case YAWC_ACTION_MOVE_TO_OUTPUT:
+            move_to_output(server, arg);
+            break;
+        case YAWC_ACTION_RELOAD:
+            server->reload_config();
+            break;
+        case YAWC_ACTION_EXIT:
+            wl_display_terminate(server->wl_display);
+            break;
+    }
+}
@@ -0,0 +1,8 @@
+#include <cstdint>
+#include <string>
+
+struct yawc_server;
+enum yawc_builtin_action : uint8_t;
+
+//keybind actions that run in process, only spawn forks
+void run_builtin_action(struct yawc_server *server, enum yawc_builtin_action action, const std::string &arg);
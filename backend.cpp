@@ -52,7 +52,7 @@ yawc_server_error yawc_server::setup_backend(){
 }
 
 yawc_output *yawc_server::create_output(struct wlr_output *wlr_output){
-    struct yawc_output* output = new yawc_output;
+    struct yawc_output* output = new yawc_output{};
     output->wlr_output = wlr_output;
     output->server = this;
 
@@ -89,3 +89,63 @@ yawc_server_error yawc_server::setup_headless_backend(){
     return yawc_server_error::OK;
 }
 
+
+bool set_virtual_output_mode(struct wlr_output *wlr_output, const yawc_virtual_output_config &cfg){
+    if(wlr_output->width == cfg.width && wlr_output->height == cfg.height && wlr_output->refresh == cfg.refresh){
+        return true;
+    }
+
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+    wlr_output_state_set_custom_mode(&state, cfg.width, cfg.height, cfg.refresh);
+
+    //the headless backend paces every output with its own timer at this refresh
+    bool ok = wlr_output_commit_state(wlr_output, &state);
+    wlr_output_state_finish(&state);
+
+    return ok;
+}
+
+//reconciles the running virtual outputs with the config, by position in the list
+void yawc_server::update_virtual_outputs(){
+    auto &wanted = this->config->virtual_outputs;
+
+    while(this->virtual_outputs.size() > wanted.size()){
+        struct wlr_output *wlr_output = this->virtual_outputs.back();
+        this->virtual_outputs.pop_back();
+
+        wlr_log(WLR_INFO, "Removing virtual output %s", wlr_output->name);
+
+        wlr_output_destroy(wlr_output);
+    }
+
+    for(size_t i = 0; i < wanted.size(); ++i){
+        auto &cfg = wanted[i];
+
+        if(i == this->virtual_outputs.size()){
+            //goes through handle_new_output like any other output, so it ends up in
+            //the layout and becomes a capture source
+            struct wlr_output *wlr_output = wlr_headless_add_output(this->headless_backend, cfg.width, cfg.height);
+
+            if(!wlr_output || !wlr_output->data){
+                wlr_log(WLR_ERROR, "Failed to create a virtual output");
+
+                if(wlr_output){
+                    wlr_output_destroy(wlr_output);
+                }
+
+                break;
+            }
+
+            this->virtual_outputs.push_back(wlr_output);
+
+            wlr_log(WLR_INFO, "Created virtual output %s", wlr_output->name);
+        }
+
+        struct wlr_output *wlr_output = this->virtual_outputs[i];
+
+        if(!set_virtual_output_mode(wlr_output, cfg)){
+            wlr_log(WLR_ERROR, "Failed to set %dx%d@%dmHz on %s", cfg.width, cfg.height, cfg.refresh, wlr_output->name);
+        }
+    }
+}
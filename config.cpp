@@ -71,9 +71,99 @@ yawc_pointer_config parse_pointer_config(toml::table &table){
     return out;
 }
 
-constexpr std::array<std::string_view, 4> reserved_tables = {
+yawc_output_config parse_output_config(toml::table &table){
+    yawc_output_config out;
+
+    auto max_render_time = table["max_render_time"];
+
+    if(auto mode = max_render_time.value<std::string>()){
+        if(*mode == "auto"){
+            out.max_render_time = -1;
+        } else if(*mode == "off"){
+            out.max_render_time = 0;
+        } else{
+            wlr_log(WLR_ERROR, "Unknown max_render_time: %s, expected \"off\", \"auto\" or ms", mode->c_str());
+        }
+    } else if(max_render_time.is_integer() && max_render_time.value<int32_t>().value_or(-1) >= 0){
+        out.max_render_time = max_render_time.value<int32_t>();
+    } else if(max_render_time){
+        wlr_log(WLR_ERROR, "max_render_time has to be \"off\", \"auto\" or a whole number of ms");
+    }
+
+    out.allow_tearing = table["allow_tearing"].value<bool>();
+
+    out.adaptive_resolution = table["adaptive_resolution"].value<bool>();
+    out.min_render_scale = table["min_render_scale"].value<float>();
+
+    out.mirror = table["mirror"].value<std::string>();
+
+    return out;
+}
+
+yawc_output_config yawc_config::get_output_config(const std::string &name){
+    yawc_output_config out = this->default_output_config;
+
+    auto it = this->output_configs.find(name);
+
+    if(it == this->output_configs.end()){
+        return out;
+    }
+
+    auto &specific = it->second;
+
+    if(specific.max_render_time.has_value()){
+        out.max_render_time = specific.max_render_time;
+    }
+
+    if(specific.allow_tearing.has_value()){
+        out.allow_tearing = specific.allow_tearing;
+    }
+
+    if(specific.adaptive_resolution.has_value()){
+        out.adaptive_resolution = specific.adaptive_resolution;
+    }
+
+    if(specific.min_render_scale.has_value()){
+        out.min_render_scale = specific.min_render_scale;
+    }
+
+    if(specific.mirror.has_value()){
+        out.mirror = specific.mirror;
+    }
+
+    return out;
+}
+
+void parse_content_type_policy(yawc_content_type_policy &policy, toml::table &table){
+    if(auto allow_tearing = table["allow_tearing"].value<bool>()){
+        policy.allow_tearing = allow_tearing;
+    }
+
+    if(auto adaptive_sync = table["adaptive_sync"].value<bool>()){
+        policy.adaptive_sync = adaptive_sync;
+    }
+
+    policy.cursor_fast_path = table["cursor_fast_path"].value_or(policy.cursor_fast_path);
+}
+
+void parse_performance_config(yawc_performance_config &out, toml::table &table){
+    out.hidden_frame_rate = std::max(0, table["hidden_frame_rate"].value_or(out.hidden_frame_rate));
+    out.hotplug_debounce_ms = std::max(0, table["hotplug_debounce_ms"].value_or(out.hotplug_debounce_ms));
+    out.pointer_coalescing = table["pointer_coalescing"].value_or(out.pointer_coalescing);
+    out.resize_configure_per_frame = table["resize_configure_per_frame"].value_or(out.resize_configure_per_frame);
+}
+
+void parse_debug_config(yawc_debug_config &out, toml::table &table){
+    out.damage = table["damage"].value_or(out.damage);
+}
+
+constexpr std::array<std::string_view, 8> reserved_tables = {
     "pointer",
     "keyboard",
+    "output",
+    "content_type",
+    "performance",
+    "debug",
     "environment",
     "keybinds",
 };
@@ -86,12 +176,58 @@ yawc_input_config attempt_keyboard_and_pointer(toml::table &table){
     return parse_pointer_config(table);
 }
 
-void parse_keybind(struct yawc_bind_node *bind, std::string_view key, std::string_view value){
-    bool is_global_shortcut = value.contains(':');
+const std::map<std::string_view, yawc_builtin_action> builtin_actions = {
+    {"spawn", YAWC_ACTION_SPAWN},
+    {"close", YAWC_ACTION_CLOSE},
+    {"fullscreen", YAWC_ACTION_FULLSCREEN},
+    {"maximize", YAWC_ACTION_MAXIMIZE},
+    {"minimize", YAWC_ACTION_MINIMIZE},
+    {"focus-next", YAWC_ACTION_FOCUS_NEXT},
+    {"focus-prev", YAWC_ACTION_FOCUS_PREV},
+    {"move-to-output", YAWC_ACTION_MOVE_TO_OUTPUT},
+    {"reload", YAWC_ACTION_RELOAD},
+    {"exit", YAWC_ACTION_EXIT},
+};
+
+uint64_t keybind_hash(uint32_t state, uint64_t id){
+    uint64_t h = (id ^ ((uint64_t)state << 40)) * 0x9e3779b97f4a7c15ull;
+
+    return h ^ (h >> 32);
+}
+
+void yawc_keybind_table::add(std::string_view key, std::string_view value){
+    auto builtin = YAWC_ACTION_NONE;
+    std::string_view builtin_arg;
+
+    if(value.starts_with('@')){
+        auto space = value.find(' ');
+        auto name = value.substr(1, space - 1); // npos - 1 still takes the rest
+
+        auto it = builtin_actions.find(name);
+
+        if(it == builtin_actions.end()){
+            wlr_log(WLR_ERROR, "Unknown keybind action: %.*s", (int)name.size(), name.data());
+            return;
+        }
+
+        builtin = it->second;
+
+        auto arg_start = value.find_first_not_of(' ', space);
+
+        if(space != std::string_view::npos && arg_start != std::string_view::npos){
+            builtin_arg = value.substr(arg_start);
+        }
+    }
+
+    bool is_global_shortcut = !builtin && value.contains(':');
+
+    if(this->states.empty()){
+        this->states.push_back({});
+    }
 
     auto words = key | std::views::split(',');
 
-    struct yawc_bind_node *cur_node = bind;
+    uint32_t cur_state = 0;
 
     for(auto el : words){
         auto key_parts = std::string_view{el} | std::views::split('+');
@@ -117,19 +253,67 @@ void parse_keybind(struct yawc_bind_node *bind, std::string_view key, std::strin
         
         uint64_t id = ((uint64_t)modifiers << 32) + button;
 
-        auto *children = &cur_node->children;
+        auto [it, inserted] = this->edges.try_emplace(std::pair{cur_state, id}, this->states.size());
 
-        if(children->find(id) != children->end()){
-            cur_node = children->at(id).get();
-        } else{
-            auto new_node = std::make_unique<struct yawc_bind_node>();
+        if(inserted){
+            this->states[cur_state].has_children = true;
+            this->states.push_back({});
+        }
+
+        cur_state = it->second;
+    }
+
+    auto &node = this->states[cur_state];
+
+    node.action = value; 
+    node.is_global_shortcut = is_global_shortcut;
+    node.builtin = builtin;
+    node.builtin_arg = builtin_arg;
+}
 
-            cur_node = children->emplace(id, std::move(new_node)).first->second.get();
+void yawc_keybind_table::compile(){
+    size_t size = 8;
+
+    while(size < this->edges.size() * 2){
+        size *= 2;
+    }
+
+    this->slots.assign(size, {});
+
+    for(auto &[from, next]: this->edges){
+        auto [state, id] = from;
+
+        size_t i = keybind_hash(state, id) & (size - 1);
+
+        while(this->slots[i].next){
+            i = (i + 1) & (size - 1);
         }
+
+        this->slots[i] = {id, state, next};
     }
 
-    cur_node->action = value; 
-    cur_node->is_global_shortcut = is_global_shortcut;
+    this->edges.clear();
+}
+
+uint32_t yawc_keybind_table::step(uint32_t state, uint64_t id) const{
+    if(this->slots.empty()){
+        return 0;
+    }
+
+    size_t mask = this->slots.size() - 1;
+
+    //never full, an empty slot always ends the probe
+    for(size_t i = keybind_hash(state, id) & mask; ; i = (i + 1) & mask){
+        auto &slot = this->slots[i];
+
+        if(!slot.next){
+            return 0;
+        }
+
+        if(slot.state == state && slot.id == id){
+            return slot.next;
+        }
+    }
 }
 
 void yawc_config::load_tables(toml::table &table){
@@ -151,6 +335,28 @@ void yawc_config::load_tables(toml::table &table){
         this->default_keyboard_config = parse_keyboard_config(*keyboard_table);
     }
 
+    auto output = table["output"];
+
+    if(toml::table *output_table = output.as_table()){
+        this->default_output_config = parse_output_config(*output_table);
+    }
+
+    if(toml::table *content_type_table = table["content_type"].as_table()){
+        for(auto &&[key, inner]: *content_type_table){
+            if(toml::table *policy_table = inner.as_table()){
+                parse_content_type_policy(this->content_type_policies[std::string{key.str()}], *policy_table);
+            }
+        }
+    }
+
+    if(toml::table *performance_table = table["performance"].as_table()){
+        parse_performance_config(this->performance, *performance_table);
+    }
+
+    if(toml::table *debug_table = table["debug"].as_table()){
+        parse_debug_config(this->debug, *debug_table);
+    }
+
     auto environment = table["environment"];
 
     if(toml::table *env_table = environment.as_table()){
@@ -161,6 +367,25 @@ void yawc_config::load_tables(toml::table &table){
         }
     }
 
+    if (toml::array *arr = table["virtual_outputs"].as_array()) {
+        for (auto &&el : *arr) {
+            toml::table *virtual_table = el.as_table();
+
+            if (!virtual_table) {
+                continue;
+            }
+
+            yawc_virtual_output_config out;
+            out.width = (*virtual_table)["width"].value_or(1920);
+            out.height = (*virtual_table)["height"].value_or(1080);
+            out.refresh = (*virtual_table)["refresh"].value_or(60.0) * 1000;
+
+            if (out.width > 0 && out.height > 0 && out.refresh > 0) {
+                this->virtual_outputs.push_back(out);
+            }
+        }
+    }
+
     auto autostart = table["autostart"];
 
     if (toml::array *arr = autostart.as_array()) {
@@ -169,7 +394,8 @@ void yawc_config::load_tables(toml::table &table){
         });
     }
 
-    this->keybind_tree = std::make_unique<struct yawc_bind_node>();
+    this->keybinds = {};
+    this->keybinds.states.push_back({}); // root
 
     if(toml::table *keybinds = table["keybinds"].as_table()){
         for(auto &&[key, inner]: *keybinds){
@@ -183,10 +409,12 @@ void yawc_config::load_tables(toml::table &table){
 
             processed_key.erase(std::remove(processed_key.begin(), processed_key.end(), ' '), processed_key.end());
             
-            parse_keybind(this->keybind_tree.get(), processed_key, **as_str);
+            this->keybinds.add(processed_key, **as_str);
         }
     }    
 
+    this->keybinds.compile();
+
     for(auto &&[key, inner]: table){
         toml::table *as_table = inner.as_table();
 
@@ -202,7 +430,9 @@ void yawc_config::load_tables(toml::table &table){
 
         const char *name = key.str().data(); 
 
-        if(table["type"] == "keyboard"){
+        if(table["type"] == "output"){
+            this->output_configs[name] = parse_output_config(table);
+        } else if(table["type"] == "keyboard"){
             this->input_configs[name] = parse_keyboard_config(table);
         } else if(table["type"] == "pointer"){
             this->input_configs[name] = parse_pointer_config(table);
@@ -215,8 +445,18 @@ void yawc_config::load_tables(toml::table &table){
 bool yawc_config::load(std::string path){
     default_pointer_config = {.enabled = true};
     default_keyboard_config = {.enabled = true};
+    default_output_config = {};
     input_configs.clear();
+    output_configs.clear();
+    performance = {};
+    debug = {};
+    content_type_policies = {
+        {"game", {.allow_tearing = true, .cursor_fast_path = true}},
+        {"video", {.adaptive_sync = true}},
+        {"photo", {.allow_tearing = false}},
+    };
     autostart_cmds.clear();
+    virtual_outputs.clear();
 
     this->last_path = path;
 
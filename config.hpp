@@ -6,6 +6,8 @@
 #include <vector>
 #include <variant>
 #include <map>
+#include <string_view>
+#include <utility>
 
 #include <toml++/toml.hpp>
 
@@ -58,11 +60,81 @@ struct yawc_keyboard_config{
 
 using yawc_input_config = std::variant<yawc_keyboard_config, yawc_pointer_config>;
 
-struct yawc_bind_node{
-    std::map<uint64_t, std::unique_ptr<yawc_bind_node>> children;
+struct yawc_output_config{
+    std::optional<int32_t> max_render_time; // ms, 0 = "off", -1 = "auto"
+    std::optional<bool> allow_tearing;
+
+    std::optional<bool> adaptive_resolution;
+    std::optional<float> min_render_scale;
+
+    std::optional<std::string> mirror; // name of the output to show instead of our own scene
+};
+
+struct yawc_virtual_output_config{
+    int32_t width, height;
+    int32_t refresh; // mHz
+};
+
+struct yawc_content_type_policy{
+    std::optional<bool> allow_tearing; // unset leaves it to wp_tearing_control_v1
+    std::optional<bool> adaptive_sync;
+
+    bool cursor_fast_path;
+};
+
+struct yawc_performance_config{
+    int32_t hidden_frame_rate = 1; // Hz for hidden/occluded toplevels, 0 = none
+    int32_t hotplug_debounce_ms = 100; // 0 = apply every output event right away
+    bool pointer_coalescing = false; // one cursor update per event loop wakeup instead of per report
+    bool resize_configure_per_frame = false; // at most one resize configure per output frame
+};
+
+struct yawc_debug_config{
+    bool damage = false; // count damage per client
+};
+
+//"@name arg" binds, run in process instead of through /bin/sh
+enum yawc_builtin_action : uint8_t{
+    YAWC_ACTION_NONE, // shell command or global shortcut
+    YAWC_ACTION_SPAWN,
+    YAWC_ACTION_CLOSE,
+    YAWC_ACTION_FULLSCREEN,
+    YAWC_ACTION_MAXIMIZE,
+    YAWC_ACTION_MINIMIZE,
+    YAWC_ACTION_FOCUS_NEXT,
+    YAWC_ACTION_FOCUS_PREV,
+    YAWC_ACTION_MOVE_TO_OUTPUT,
+    YAWC_ACTION_RELOAD,
+    YAWC_ACTION_EXIT,
+};
 
+struct yawc_bind_node{
     std::string action; 
     bool is_global_shortcut; //if action has : in it
+    bool has_children;
+
+    enum yawc_builtin_action builtin;
+    std::string builtin_arg;
+};
+
+//the bind tree flattened at load, one open addressed table holds every (state, chord) -> state edge
+struct yawc_keybind_table{
+    struct slot{
+        uint64_t id; // modifiers << 32 | keysym
+        uint32_t state;
+        uint32_t next; // 0 if the slot is empty, the root is never a target
+    };
+
+    std::vector<yawc_bind_node> states; // states[0] is the root
+    std::vector<slot> slots; // power of two sized, at most half full
+
+    void add(std::string_view key, std::string_view value);
+    void compile();
+
+    uint32_t step(uint32_t state, uint64_t id) const; // 0 if there's no edge
+
+    private:
+    std::map<std::pair<uint32_t, uint64_t>, uint32_t> edges; // only while loading
 };
 
 struct yawc_config{
@@ -70,9 +142,22 @@ struct yawc_config{
     yawc_keyboard_config default_keyboard_config;
 
     std::map<std::string, yawc_input_config> input_configs;
+
+    yawc_output_config default_output_config;
+    std::map<std::string, yawc_output_config> output_configs;
+
+    yawc_output_config get_output_config(const std::string &name);
+
+    std::map<std::string, yawc_content_type_policy> content_type_policies; // "game", "video", "photo"
+
+    yawc_performance_config performance;
+    yawc_debug_config debug;
+
+    std::vector<yawc_virtual_output_config> virtual_outputs;
+
     std::vector<std::string> autostart_cmds;
     
-    std::unique_ptr<struct yawc_bind_node> keybind_tree;
+    struct yawc_keybind_table keybinds;
 
     bool load(std::string path);
 
@@ -0,0 +1,117 @@
+#include "content_policy.hpp"
+
+#include "toplevel.hpp"
+
+const char *content_type_name(enum wp_content_type_v1_type type){
+    switch(type){
+        case WP_CONTENT_TYPE_V1_TYPE_PHOTO:
+            return "photo";
+        case WP_CONTENT_TYPE_V1_TYPE_VIDEO:
+            return "video";
+        case WP_CONTENT_TYPE_V1_TYPE_GAME:
+            return "game";
+        default:
+            return nullptr;
+    }
+}
+
+void request_adaptive_sync(struct yawc_output *output, bool enabled){
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+    wlr_output_state_set_adaptive_sync_enabled(&state, enabled);
+
+    bool ok = wlr_output_test_state(output->wlr_output, &state);
+
+    wlr_output_state_finish(&state);
+
+    if(!ok){
+        wlr_log(WLR_INFO, "Output %s refused adaptive sync = %d", output->wlr_output->name, enabled);
+        return;
+    }
+
+    //rides along the next frame instead of fighting the pending page flip
+    output->pending_adaptive_sync = enabled;
+    output->forced_adaptive_sync = enabled;
+
+    wlr_output_schedule_frame(output->wlr_output);
+}
+
+void content_policy_update(struct yawc_output *output){
+    auto *server = output->server;
+
+    if(output == server->fallback_output){
+        return;
+    }
+
+    auto type = WP_CONTENT_TYPE_V1_TYPE_NONE;
+
+    if(output->occupant && output->occupant->mapped){
+        type = wlr_surface_get_content_type_v1(server->content_type_manager,
+            output->occupant->xdg_toplevel->base->surface);
+    }
+
+    output->policy.reset();
+
+    if(const char *name = content_type_name(type)){
+        auto it = server->config->content_type_policies.find(name);
+
+        if(it != server->config->content_type_policies.end()){
+            output->policy = it->second;
+        }
+    }
+
+    bool wants_adaptive_sync = output->policy && output->policy->adaptive_sync.value_or(false);
+    bool has_adaptive_sync = output->wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED;
+
+    if(wants_adaptive_sync && !has_adaptive_sync && !output->forced_adaptive_sync){
+        request_adaptive_sync(output, true);
+    } else if(!wants_adaptive_sync && output->forced_adaptive_sync){
+        request_adaptive_sync(output, false);
+    }
+}
+
+bool content_policy_pointer_motion(struct yawc_server *server, uint32_t time){
+    if(server->drag.running || server->cur_lock.lock){
+        return false;
+    }
+
+    auto *wlr_output = wlr_output_layout_output_at(server->output_layout, server->cursor->x, server->cursor->y);
+
+    if(!wlr_output || !wlr_output->data){
+        return false;
+    }
+
+    auto *output = static_cast<struct yawc_output*>(wlr_output->data);
+    auto *toplevel = output->occupant;
+
+    if(!output->policy || !output->policy->cursor_fast_path || !toplevel || !toplevel->mapped){
+        return false;
+    }
+
+    auto *xdg_surface = toplevel->xdg_toplevel->base;
+    struct wlr_surface *surface = xdg_surface->surface;
+
+    //only while the game owns both foci and nothing could sit on top of it
+    if(server->seat->pointer_state.focused_surface != surface 
+            || server->seat->keyboard_state.focused_surface != surface){
+        return false;
+    }
+
+    if(!wl_list_empty(&xdg_surface->popups) || !wl_list_empty(&surface->current.subsurfaces_above)){
+        return false;
+    }
+
+    int lx, ly;
+    wlr_scene_node_coords(&toplevel->scene_tree->node, &lx, &ly);
+
+    double sx = server->cursor->x - lx;
+    double sy = server->cursor->y - ly;
+
+    if(sx < 0 || sy < 0 || sx >= surface->current.width || sy >= surface->current.height){
+        return false;
+    }
+
+    wlr_seat_pointer_notify_motion(server->seat, time, sx, sy);
+
+    return true;
+}
@@ -0,0 +1,10 @@
+#include <cstdint>
+
+struct yawc_server;
+struct yawc_output;
+
+//looks up the content type of the output occupant and applies its policy
+void content_policy_update(struct yawc_output *output);
+
+//returns true if the motion was delivered straight to a game surface
+bool content_policy_pointer_motion(struct yawc_server *server, uint32_t time);
@@ -0,0 +1,97 @@
+#include "server.hpp"
+
+#include "cursor_image.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <wlr/xcursor.h>
+
+void cursor_set_image(struct yawc_server *server, const char *name){
+    if(server->cursor_image == name){
+        return;
+    }
+
+    server->cursor_image = name;
+
+    wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, name);
+}
+
+void cursor_set_surface(struct yawc_server *server, struct wlr_surface *surface, int hotspot_x, int hotspot_y){
+    //the client owns the image now, the next named one has to go through
+    server->cursor_image.clear();
+
+    wlr_cursor_set_surface(server->cursor, surface, hotspot_x, hotspot_y);
+}
+
+void cursor_unset_image(struct yawc_server *server){
+    server->cursor_image.clear();
+
+    wlr_cursor_unset_image(server->cursor);
+}
+
+bool cursor_scale_loaded(struct wlr_xcursor_manager *manager, float scale){
+    struct wlr_xcursor_manager_theme *theme;
+    wl_list_for_each(theme, &manager->scaled_themes, link){
+        if(theme->scale == scale){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void cursor_preload_scale(struct yawc_server *server, float scale){
+    auto *manager = server->cursor_mgr;
+
+    if(!manager || scale <= 0){
+        return;
+    }
+
+    auto &loading = server->cursor_scales_loading;
+
+    if(cursor_scale_loaded(manager, scale) || std::find(loading.begin(), loading.end(), scale) != loading.end()){
+        return;
+    }
+
+    loading.push_back(scale);
+
+    std::string name = manager->name ? manager->name : "";
+    int size = manager->size * scale;
+
+    auto result = std::make_shared<struct wlr_xcursor_theme*>(nullptr);
+
+    worker_pool_submit(&server->workers, [=]{
+        //only file reads and decoding, nothing shared with the main thread
+        *result = wlr_xcursor_theme_load(name.empty() ? nullptr : name.c_str(), size);
+    }, [=]{
+        std::erase(server->cursor_scales_loading, scale);
+
+        struct wlr_xcursor_theme *theme = *result;
+
+        if(!theme){
+            wlr_log(WLR_ERROR, "Failed to load the cursor theme at scale %.2f", scale);
+            return;
+        }
+
+        //wlr_cursor might have needed it first and loaded it itself
+        if(cursor_scale_loaded(server->cursor_mgr, scale)){
+            wlr_xcursor_theme_destroy(theme);
+            return;
+        }
+
+        //same thing wlr_xcursor_manager_load does, it frees these on destroy
+        auto *scaled = static_cast<struct wlr_xcursor_manager_theme*>(calloc(1, sizeof(struct wlr_xcursor_manager_theme)));
+
+        if(!scaled){
+            wlr_xcursor_theme_destroy(theme);
+            return;
+        }
+
+        scaled->scale = scale;
+        scaled->theme = theme;
+        wl_list_insert(&server->cursor_mgr->scaled_themes, &scaled->link);
+
+        wlr_log(WLR_DEBUG, "Preloaded the cursor theme at scale %.2f", scale);
+    });
+}
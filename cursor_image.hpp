@@ -0,0 +1,11 @@
+struct yawc_server;
+struct wlr_surface;
+
+//only touches the cursor when the image actually changes
+void cursor_set_image(struct yawc_server *server, const char *name);
+void cursor_set_surface(struct yawc_server *server, struct wlr_surface *surface, int hotspot_x, int hotspot_y);
+void cursor_unset_image(struct yawc_server *server);
+
+//loads the theme for scale on a worker and hands it to the xcursor manager,
+//so the first cursor on a new output doesn't read the theme from disk on the main thread
+void cursor_preload_scale(struct yawc_server *server, float scale);
@@ -0,0 +1,195 @@
+#include "server.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+
+struct yawc_damage_tracker {
+    struct yawc_server *server;
+    struct wlr_surface *surface;
+
+    struct wl_listener commit;
+    struct wl_listener destroy;
+};
+
+uint64_t region_area(const pixman_region32_t *region){
+    int count;
+    pixman_box32_t *rects = pixman_region32_rectangles(region, &count);
+
+    uint64_t area = 0;
+
+    for(int i = 0; i < count; ++i){
+        area += (uint64_t)(rects[i].x2 - rects[i].x1) * (rects[i].y2 - rects[i].y1);
+    }
+
+    return area;
+}
+
+std::string damage_source_name(struct wlr_surface *surface){
+    surface = wlr_surface_get_root_surface(surface);
+
+    //popups belong to whoever owns their toplevel
+    struct wlr_xdg_surface *xdg_surface;
+    while((xdg_surface = wlr_xdg_surface_try_from_wlr_surface(surface))){
+        if(xdg_surface->role == WLR_XDG_SURFACE_ROLE_TOPLEVEL && xdg_surface->toplevel->app_id){
+            return xdg_surface->toplevel->app_id;
+        }
+
+        if(xdg_surface->role != WLR_XDG_SURFACE_ROLE_POPUP || !xdg_surface->popup->parent){
+            break;
+        }
+
+        surface = wlr_surface_get_root_surface(xdg_surface->popup->parent);
+    }
+
+    if(struct wlr_layer_surface_v1 *layer = utils::toplevel_layer_surface_from_surface(surface)){
+        return std::string{"layer:"} + (layer->namespace_ ? layer->namespace_ : "");
+    }
+
+    pid_t pid = 0;
+    wl_client_get_credentials(wl_resource_get_client(surface->resource), &pid, nullptr, nullptr);
+
+    return "pid:" + std::to_string(pid);
+}
+
+void handle_tracked_surface_commit(struct wl_listener *listener, void *data){
+    struct yawc_damage_tracker *tracker = wl_container_of(listener, tracker, commit);
+    auto *server = tracker->server;
+    auto *surface = tracker->surface;
+
+    input_latency_damage(server, surface);
+
+    if(!server->damage_debug || wl_list_empty(&surface->current_outputs)){
+        return;
+    }
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+
+    wlr_surface_get_effective_damage(surface, &damage);
+
+    uint64_t area = region_area(&damage);
+
+    pixman_region32_fini(&damage);
+
+    if(!area){
+        return;
+    }
+
+    std::string source = damage_source_name(surface);
+
+    struct wlr_surface_output *surface_output;
+    wl_list_for_each(surface_output, &surface->current_outputs, link){
+        auto *output = static_cast<struct yawc_output*>(surface_output->output->data);
+
+        if(!output){
+            continue;
+        }
+
+        float scale = surface_output->output->scale;
+        output->damage.pending[source] += area * scale * scale;
+    }
+}
+
+void handle_tracked_surface_destroy(struct wl_listener *listener, void *data){
+    struct yawc_damage_tracker *tracker = wl_container_of(listener, tracker, destroy);
+
+    input_latency_surface_destroyed(tracker->server, tracker->surface);
+
+    wl_list_remove(&tracker->commit.link);
+    wl_list_remove(&tracker->destroy.link);
+
+    delete tracker;
+}
+
+void handle_damage_new_surface(struct wl_listener *listener, void *data){
+    struct yawc_server *server = wl_container_of(listener, server, damage_new_surface);
+    struct wlr_surface *surface = static_cast<struct wlr_surface*>(data);
+
+    auto *tracker = new yawc_damage_tracker{};
+    tracker->server = server;
+    tracker->surface = surface;
+
+    tracker->commit.notify = handle_tracked_surface_commit;
+    wl_signal_add(&surface->events.commit, &tracker->commit);
+
+    tracker->destroy.notify = handle_tracked_surface_destroy;
+    wl_signal_add(&surface->events.destroy, &tracker->destroy);
+}
+
+void damage_debug_init(struct yawc_server *server){
+    //every surface is tracked from the start so toggling at runtime sees all of them
+    server->damage_new_surface.notify = handle_damage_new_surface;
+    wl_signal_add(&server->compositor->events.new_surface, &server->damage_new_surface);
+}
+
+void damage_debug_set_enabled(struct yawc_server *server, bool enabled){
+    if(enabled == server->damage_debug){
+        return;
+    }
+
+    server->damage_debug = enabled;
+
+    //only the numbers, the tint is wlroots' WLR_SCENE_DEBUG_DAMAGE=highlight read when the scene is created
+    struct yawc_output *output;
+    wl_list_for_each(output, &server->outputs, link){
+        output->damage = {};
+    }
+
+    wlr_log(WLR_INFO, "Damage debugging %s", enabled ? "enabled" : "disabled");
+}
+
+void damage_debug_attribute(struct yawc_server *server, const std::string &source, const struct wlr_box &box){
+    if(!server->damage_debug){
+        return;
+    }
+
+    struct yawc_output *output;
+    wl_list_for_each(output, &server->outputs, link){
+        struct wlr_box output_box, intersection;
+        wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+
+        if(!wlr_box_intersection(&intersection, &output_box, &box)){
+            continue;
+        }
+
+        float scale = output->wlr_output->scale;
+        output->damage.pending[source] += (double)intersection.width * intersection.height * scale * scale;
+    }
+}
+
+void damage_debug_frame(struct yawc_output *output, const struct wlr_output_state *state){
+    auto *server = output->server;
+    auto *stats = &output->damage;
+
+    if(!server->damage_debug || !state->buffer){
+        return;
+    }
+
+    double output_area = (double)output->wlr_output->width * output->wlr_output->height;
+
+    if(output_area <= 0){
+        return;
+    }
+
+    //no damage on the state means all of it
+    double percent = state->committed & WLR_OUTPUT_STATE_DAMAGE
+        ? region_area(&state->damage) * 100.0 / output_area
+        : 100.0;
+
+    stats->frames++;
+    stats->percent_sum += std::min(percent, 100.0);
+
+    if(percent >= 100.0){
+        stats->full_frames++;
+    }
+
+    for(auto &[source, area]: stats->pending){
+        auto *source_stats = &stats->sources[source];
+
+        source_stats->frames++;
+        source_stats->percent_sum += std::min(area * 100.0 / output_area, 100.0);
+    }
+
+    stats->pending.clear();
+}
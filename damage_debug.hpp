@@ -0,0 +1,31 @@
+#include <cstdint>
+#include <map>
+#include <string>
+
+struct yawc_server;
+struct yawc_output;
+struct wlr_box;
+struct wlr_output_state;
+
+struct yawc_damage_source_stats {
+    uint64_t frames;
+    double percent_sum;
+};
+
+//only filled while damage debugging is on
+struct yawc_damage_stats {
+    uint64_t frames, full_frames;
+    double percent_sum;
+
+    std::map<std::string, double> pending; // output pixels damaged by each source since the last frame
+    std::map<std::string, yawc_damage_source_stats> sources;
+};
+
+void damage_debug_init(struct yawc_server *server);
+void damage_debug_set_enabled(struct yawc_server *server, bool enabled);
+
+//for damage that doesn't come from a client commit (wm buffers and overlays)
+void damage_debug_attribute(struct yawc_server *server, const std::string &source, const struct wlr_box &box);
+
+//call with the built state, its damage is what the frame repainted
+void damage_debug_frame(struct yawc_output *output, const struct wlr_output_state *state);
@@ -92,16 +92,12 @@ bool hover_cursor = false;
 bool on_pointer_move(wm_pointer_event_t *event){
     destroy_task_switcher(&task_switcher); //we stop drawing the window list if it's there
 
-    wm_node node = {NULL};
-
-    wm_try_get_node_at_coords(&node, event->global_x, event->global_y);
-
-    if(!node.node){
+    if(!event->node.node){
         return true;
     }
 
-    uint32_t edges = wm_try_get_resize_grip(&node, NULL); 
-    //that returns us the edges that the pointer is on
+    uint32_t edges = event->resize_edges; 
+    //the edges that the pointer is on
 
     if(edges != WM_RESIZE_EDGE_INVALID){
         wm_set_cursor(wm_get_cursor_name_from_edges(edges));
@@ -218,12 +214,12 @@ void handle_border_gesture(wm_pointer_event_t *event, wm_toplevel *cur_toplevel)
 }
 
 bool on_pointer_button(wm_pointer_event_t *event){
-    wm_node node = {NULL};
+    wm_node node = event->node;
 
     wm_toplevel *toplevel = NULL;
     uint32_t edges = WM_RESIZE_EDGE_INVALID;
 
-    wm_node_coords_t coords = wm_try_get_node_at_coords(&node, event->global_x, event->global_y);
+    wm_node_coords_t coords = event->coords;
 
     if(!node.node){
         return true;
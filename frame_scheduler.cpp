@@ -0,0 +1,129 @@
+#include "frame_scheduler.hpp"
+
+#include "server.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+
+constexpr int64_t MIN_MARGIN_NS = 500000;
+constexpr int64_t INITIAL_MARGIN_NS = 1000000;
+constexpr int64_t MIN_DELAY_NS = 1000000; // the event loop timers only have ms precision
+
+void output_render(struct yawc_output *output);
+
+int handle_render_timer(void *data){
+    struct yawc_output *output = static_cast<struct yawc_output*>(data);
+
+    output->scheduler.waiting = false;
+
+    output_render(output);
+
+    return 0;
+}
+
+void frame_scheduler_init(struct yawc_output *output){
+    auto *scheduler = &output->scheduler;
+
+    *scheduler = {};
+
+    scheduler->margin_ns = INITIAL_MARGIN_NS;
+    scheduler->timer = wl_event_loop_add_timer(output->server->wl_event_loop, handle_render_timer, output);
+}
+
+void frame_scheduler_finish(struct yawc_output *output){
+    auto *scheduler = &output->scheduler;
+
+    if(scheduler->timer){
+        wl_event_source_remove(scheduler->timer);
+        scheduler->timer = nullptr;
+    }
+
+    scheduler->waiting = false;
+}
+
+int64_t render_budget(struct yawc_output *output){
+    auto *scheduler = &output->scheduler;
+    int32_t max_render_time = output->config.max_render_time.value_or(0);
+
+    if(max_render_time > 0){
+        return (int64_t)max_render_time * 1000000;
+    }
+
+    return scheduler->render_cost_ns + scheduler->margin_ns;
+}
+
+bool frame_scheduler_delay(struct yawc_output *output){
+    auto *scheduler = &output->scheduler;
+
+    if(scheduler->waiting){
+        return true;
+    }
+
+    scheduler->target_vblank_ns = 0;
+
+    if(!scheduler->timer || !output->config.max_render_time.value_or(0)){
+        return false;
+    }
+
+    if(!scheduler->refresh_ns || !scheduler->last_presentation_ns || output->wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED){
+        return false; //nothing to predict
+    }
+
+    int64_t now = utils::now_ns();
+    int64_t refresh = scheduler->refresh_ns;
+
+    int64_t since_presentation = now - scheduler->last_presentation_ns;
+    int64_t next_vblank = scheduler->last_presentation_ns + (since_presentation / refresh + 1) * refresh;
+
+    scheduler->target_vblank_ns = next_vblank;
+
+    int64_t delay = next_vblank - render_budget(output) - now;
+
+    if(delay < MIN_DELAY_NS){
+        return false;
+    }
+
+    scheduler->waiting = true;
+    wl_event_source_timer_update(scheduler->timer, delay / 1000000);
+
+    return true;
+}
+
+void frame_scheduler_record(struct yawc_output *output, int64_t start_ns, int64_t end_ns){
+    auto *scheduler = &output->scheduler;
+    int64_t cost = end_ns - start_ns;
+
+    //follow spikes right away, decay slowly so a single fast frame doesn't eat the budget
+    if(cost > scheduler->render_cost_ns){
+        scheduler->render_cost_ns = cost;
+    } else{
+        scheduler->render_cost_ns -= (scheduler->render_cost_ns - cost) / 32;
+    }
+}
+
+void frame_scheduler_presented(struct yawc_output *output, struct wlr_output_event_present *event){
+    auto *scheduler = &output->scheduler;
+
+    if(!event->presented){
+        return;
+    }
+
+    int64_t when = utils::timespec_to_ns(event->when);
+
+    scheduler->last_presentation_ns = when;
+    scheduler->refresh_ns = event->refresh;
+
+    if(!scheduler->target_vblank_ns || !scheduler->refresh_ns){
+        return;
+    }
+
+    bool missed = when > scheduler->target_vblank_ns + scheduler->refresh_ns / 2;
+
+    if(missed){
+        scheduler->margin_ns = std::min(scheduler->margin_ns * 2, scheduler->refresh_ns / 2);
+    } else{
+        scheduler->margin_ns = std::max(scheduler->margin_ns - scheduler->margin_ns / 64, MIN_MARGIN_NS);
+    }
+
+    scheduler->target_vblank_ns = 0;
+}
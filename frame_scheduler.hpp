@@ -0,0 +1,13 @@
+#include <cstdint>
+
+struct yawc_output;
+struct wlr_output_event_present;
+
+void frame_scheduler_init(struct yawc_output *output);
+void frame_scheduler_finish(struct yawc_output *output);
+
+//returns true if the render got pushed closer to the next vblank
+bool frame_scheduler_delay(struct yawc_output *output);
+
+void frame_scheduler_record(struct yawc_output *output, int64_t start_ns, int64_t end_ns);
+void frame_scheduler_presented(struct yawc_output *output, struct wlr_output_event_present *event);
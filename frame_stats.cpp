@@ -0,0 +1,299 @@
+#include "server.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+constexpr const char *metric_names[YAWC_METRIC_COUNT] = {
+    "needs_frame",
+    "build_state",
+    "commit_tearing",
+    "commit_vsync",
+    "commit_to_present",
+};
+
+int bucket_of(uint64_t value){
+    if(value < yawc_histogram::SUB_COUNT){
+        return value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - yawc_histogram::SUB_BITS;
+
+    return ((shift + 1) << yawc_histogram::SUB_BITS) + ((value >> shift) & (yawc_histogram::SUB_COUNT - 1));
+}
+
+uint64_t bucket_upper_bound(int bucket){
+    if(bucket < yawc_histogram::SUB_COUNT){
+        return bucket;
+    }
+
+    int shift = (bucket >> yawc_histogram::SUB_BITS) - 1;
+    uint64_t sub = bucket & (yawc_histogram::SUB_COUNT - 1);
+
+    return ((yawc_histogram::SUB_COUNT + sub) << shift) + ((1ull << shift) - 1);
+}
+
+void yawc_histogram::record(uint64_t value){
+    this->counts[bucket_of(value)]++;
+    this->total++;
+
+    if(value > this->max){
+        this->max = value;
+    }
+}
+
+uint64_t yawc_histogram::percentile(double p) const{
+    if(!this->total){
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(p * (this->total - 1)) + 1;
+    uint64_t seen = 0;
+
+    for(int i = 0; i < BUCKETS; ++i){
+        seen += this->counts[i];
+
+        if(seen >= rank){
+            return std::min(bucket_upper_bound(i), this->max);
+        }
+    }
+
+    return this->max;
+}
+
+void yawc_histogram::reset(){
+    this->counts.fill(0);
+    this->total = 0;
+    this->max = 0;
+}
+
+void frame_stats_aggregate(struct yawc_frame_stats *stats){
+    for(int i = 0; i < YAWC_METRIC_COUNT; ++i){
+        auto *histogram = &stats->histograms[i];
+
+        stats->rings[i].drain([histogram](uint64_t value){
+            histogram->record(value);
+        });
+    }
+}
+
+void frame_stats_record(struct yawc_output *output, enum yawc_frame_metric metric, int64_t start_ns, int64_t end_ns){
+    auto *stats = &output->stats;
+    auto *ring = &stats->rings[metric];
+
+    if(!ring->push(end_ns > start_ns ? end_ns - start_ns : 0)){
+        stats->dropped++;
+    }
+
+    //a few hundred adds, cheaper here than handing them to another thread
+    if(ring->pending() >= YAWC_FRAME_STATS_RING_SIZE / 2){
+        frame_stats_aggregate(stats);
+    }
+}
+
+void frame_stats_finish(struct yawc_output *output){
+    //stamps waiting for our next commit would match a new output at the same address
+    std::erase_if(output->server->input_latency.pending, [output](yawc_input_stamp &stamp){
+        return stamp.output == output;
+    });
+}
+
+void input_latency_add(struct yawc_server *server, struct wlr_input_device *device, struct wlr_surface *surface, struct yawc_output *output){
+    int64_t now = utils::now_ns();
+
+    const char *name = device->name ? device->name : "unknown";
+    auto &pending = server->input_latency.pending;
+
+    //input that never caused any damage doesn't get a sample
+    std::erase_if(pending, [now](yawc_input_stamp &stamp){
+        return now - stamp.ns > YAWC_INPUT_LATENCY_MAX_NS;
+    });
+
+    //the first event since the last frame is the one that waited the longest
+    for(auto &stamp: pending){
+        if(stamp.device == name && stamp.surface == surface && (surface || stamp.output == output)){
+            return;
+        }
+    }
+
+    pending.push_back({name, surface, output, now});
+}
+
+void input_latency_mark(struct yawc_server *server, struct wlr_input_device *device, struct wlr_surface *surface){
+    if(!surface){
+        return;
+    }
+
+    input_latency_add(server, device, wlr_surface_get_root_surface(surface), nullptr);
+}
+
+void input_latency_mark_cursor(struct yawc_server *server, struct wlr_input_device *device, struct yawc_output *output){
+    if(!output){
+        return;
+    }
+
+    //a moved cursor is damage on the output it's on
+    input_latency_add(server, device, nullptr, output);
+}
+
+void input_latency_damage(struct yawc_server *server, struct wlr_surface *surface){
+    auto &pending = server->input_latency.pending;
+
+    if(pending.empty() || wl_list_empty(&surface->current_outputs)){
+        return;
+    }
+
+    auto *root = wlr_surface_get_root_surface(surface);
+
+    auto waiting = std::find_if(pending.begin(), pending.end(), [root](yawc_input_stamp &stamp){
+        return stamp.surface == root && !stamp.damaged;
+    });
+
+    if(waiting == pending.end()){
+        return;
+    }
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+
+    wlr_surface_get_effective_damage(surface, &damage);
+
+    bool damaged = pixman_region32_not_empty(&damage);
+
+    pixman_region32_fini(&damage);
+
+    if(!damaged){
+        return;
+    }
+
+    for(auto &stamp: pending){
+        if(stamp.surface == root){
+            stamp.damaged = true;
+        }
+    }
+}
+
+void input_latency_surface_destroyed(struct yawc_server *server, struct wlr_surface *surface){
+    std::erase_if(server->input_latency.pending, [surface](yawc_input_stamp &stamp){
+        return stamp.surface == surface;
+    });
+}
+
+bool surface_on_output(struct wlr_surface *surface, struct yawc_output *output){
+    struct wlr_surface_output *surface_output;
+    wl_list_for_each(surface_output, &surface->current_outputs, link){
+        if(surface_output->output == output->wlr_output){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void input_latency_committed(struct yawc_output *output){
+    auto &pending = output->server->input_latency.pending;
+
+    if(pending.empty()){
+        return;
+    }
+
+    int64_t now = utils::now_ns();
+
+    //only the frame that carries the damage the input caused closes its stamp
+    std::erase_if(pending, [output, now](yawc_input_stamp &stamp){
+        if(now - stamp.ns > YAWC_INPUT_LATENCY_MAX_NS){
+            return true;
+        }
+
+        bool shown = stamp.surface
+            ? stamp.damaged && surface_on_output(stamp.surface, output)
+            : stamp.output == output;
+
+        if(!shown){
+            return false;
+        }
+
+        output->stats.inputs.push_back(std::move(stamp));
+
+        return true;
+    });
+}
+
+void input_latency_presented(struct yawc_output *output, const struct wlr_output_event_present *event){
+    auto &inputs = output->stats.inputs;
+
+    if(event->presented){
+        int64_t when = utils::timespec_to_ns(event->when);
+        auto &devices = output->server->input_latency.devices;
+
+        for(auto &stamp: inputs){
+            devices[stamp.device].record(when > stamp.ns ? when - stamp.ns : 0);
+        }
+    }
+
+    inputs.clear();
+}
+
+bool frame_stats_dump(struct yawc_server *server, const std::string &path){
+    //written aside and renamed so readers never see half a report
+    std::string tmp_path = path + ".tmp";
+
+    std::ofstream file(tmp_path, std::ios_base::trunc | std::ios_base::out);
+
+    if(!file.is_open()){
+        return false;
+    }
+
+    struct yawc_output *output;
+    wl_list_for_each(output, &server->outputs, link){
+        if(output == server->fallback_output){
+            continue;
+        }
+
+        frame_stats_aggregate(&output->stats);
+
+        file << output->wlr_output->name << " (dropped samples: " << output->stats.dropped << ")\n";
+
+        for(int i = 0; i < YAWC_METRIC_COUNT; ++i){
+            auto *histogram = &output->stats.histograms[i];
+
+            file << "  " << metric_names[i]
+                << " samples=" << histogram->total
+                << " p50=" << histogram->percentile(0.5) / 1000
+                << "us p99=" << histogram->percentile(0.99) / 1000
+                << "us p999=" << histogram->percentile(0.999) / 1000
+                << "us max=" << histogram->max / 1000 << "us\n";
+        }
+
+        auto *damage = &output->damage;
+
+        if(!damage->frames){
+            continue;
+        }
+
+        file << "  damage frames=" << damage->frames
+            << " full=" << damage->full_frames
+            << " avg=" << damage->percent_sum / damage->frames << "%\n";
+
+        for(auto &[source, source_stats]: damage->sources){
+            file << "    " << source
+                << " frames=" << source_stats.frames
+                << " avg=" << source_stats.percent_sum / source_stats.frames << "%\n";
+        }
+    }
+
+    for(auto &[device, histogram]: server->input_latency.devices){
+        file << "input " << device
+            << " samples=" << histogram.total
+            << " p50=" << histogram.percentile(0.5) / 1000
+            << "us p99=" << histogram.percentile(0.99) / 1000
+            << "us max=" << histogram.max / 1000 << "us\n";
+    }
+
+    file.close();
+
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,126 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct yawc_server;
+struct yawc_output;
+struct wlr_input_device;
+struct wlr_surface;
+struct wlr_output_event_present;
+
+enum yawc_frame_metric {
+    YAWC_METRIC_NEEDS_FRAME,
+    YAWC_METRIC_BUILD_STATE,
+    YAWC_METRIC_COMMIT_TEARING,
+    YAWC_METRIC_COMMIT_VSYNC,
+    YAWC_METRIC_PRESENT,
+    YAWC_METRIC_COUNT
+};
+
+//single producer, single consumer. the producer never blocks, if the consumer
+//falls behind samples get dropped
+template<size_t N>
+struct yawc_sample_ring {
+    std::array<uint64_t, N> samples;
+
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+
+    bool push(uint64_t value){
+        size_t h = head.load(std::memory_order_relaxed);
+
+        if(h - tail.load(std::memory_order_acquire) >= N){
+            return false;
+        }
+
+        samples[h % N] = value;
+        head.store(h + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    size_t pending() const{
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    template<typename F>
+    size_t drain(F &&fn){
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+
+        size_t amount = h - t;
+
+        for(; t != h; ++t){
+            fn(samples[t % N]);
+        }
+
+        tail.store(t, std::memory_order_release);
+
+        return amount;
+    }
+};
+
+//log-linear buckets (16 per power of two), values are within ~6% of the real one
+struct yawc_histogram {
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    std::array<uint64_t, BUCKETS> counts{};
+
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    void record(uint64_t value);
+    uint64_t percentile(double p) const;
+    void reset();
+};
+
+constexpr size_t YAWC_FRAME_STATS_RING_SIZE = 1024;
+
+//input nobody drew within this long didn't cause a frame
+constexpr int64_t YAWC_INPUT_LATENCY_MAX_NS = 1000000000;
+
+struct yawc_input_stamp {
+    std::string device;
+    struct wlr_surface *surface; // root surface the input went to, nullptr for cursor motion
+    struct yawc_output *output; // cursor motion: the output the cursor is on
+    int64_t ns;
+    bool damaged; // the surface committed damage since
+};
+
+struct yawc_input_latency {
+    std::vector<yawc_input_stamp> pending; // waiting for their damage to be committed, oldest per device and target
+    std::map<std::string, yawc_histogram> devices;
+};
+
+struct yawc_frame_stats {
+    std::array<yawc_sample_ring<YAWC_FRAME_STATS_RING_SIZE>, YAWC_METRIC_COUNT> rings;
+
+    //rings get drained into these when half full and on every dump
+    std::array<yawc_histogram, YAWC_METRIC_COUNT> histograms;
+
+    uint64_t dropped;
+
+    int64_t commit_ns; // 0 if no commit is waiting for its presentation
+    std::vector<yawc_input_stamp> inputs; // input that commit carries
+};
+
+void frame_stats_record(struct yawc_output *output, enum yawc_frame_metric metric, int64_t start_ns, int64_t end_ns);
+void frame_stats_aggregate(struct yawc_frame_stats *stats);
+void frame_stats_finish(struct yawc_output *output);
+
+//input to photon, stamped when the event comes in and closed by the presentation of the
+//first frame that carries the damage it caused. input that causes none is dropped
+void input_latency_mark(struct yawc_server *server, struct wlr_input_device *device, struct wlr_surface *surface);
+void input_latency_mark_cursor(struct yawc_server *server, struct wlr_input_device *device, struct yawc_output *output);
+void input_latency_damage(struct yawc_server *server, struct wlr_surface *surface); // on every surface commit
+void input_latency_surface_destroyed(struct yawc_server *server, struct wlr_surface *surface);
+void input_latency_committed(struct yawc_output *output);
+void input_latency_presented(struct yawc_output *output, const struct wlr_output_event_present *event);
+
+bool frame_stats_dump(struct yawc_server *server, const std::string &path);
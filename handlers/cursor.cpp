@@ -4,8 +4,15 @@
 #include "../utils.hpp"
 #include "../window_ops.hpp"
 #include "../wm_defs.hpp"
+#include "../content_policy.hpp"
+#include "../cursor_image.hpp"
 
 void yawc_server::reset_cursor_mode(){
+    //whatever size the grab ended on has to reach the client
+    if(this->current_mouse_operation == RESIZING && this->grabbed_toplevel && this->grabbed_toplevel->mapped){
+        this->grabbed_toplevel->flush_interactive_resize();
+    }
+
     this->current_mouse_operation = NOTHING;
     this->grabbed_toplevel = nullptr;
     this->grabbed_mov_x = this->grabbed_mov_y = 0;
@@ -30,8 +37,9 @@ bool yawc_server::do_mouse_operation()
         wlr_scene_node_set_position(&this->grabbed_toplevel->scene_tree->node,
             new_x,
             new_y);
+        hit_index_update(this, &this->grabbed_toplevel->scene_tree->node);
 
-        wlr_cursor_set_xcursor(this->cursor, this->cursor_mgr, "grabbing");
+        cursor_set_image(this, "grabbing");
 
         return true;
     }
@@ -67,21 +75,15 @@ bool yawc_server::do_mouse_operation()
             }
         }
 
-        struct wlr_box geo_box = this->grabbed_toplevel->xdg_toplevel->base->geometry;
-
-        wlr_scene_node_set_position(&this->grabbed_toplevel->scene_tree->node,
-            new_left - geo_box.x, new_top - geo_box.y);
-
         int new_width = new_right - new_left;
         int new_height = new_bottom - new_top;
 
-        geo_box.width = new_width;
-        geo_box.height = new_height;
-
-        geo_box.x = new_left;
-        geo_box.y = new_top;
-
-        wlr_xdg_toplevel_set_size(this->grabbed_toplevel->xdg_toplevel, geo_box.width, geo_box.height);
+        //moving now would shift the old buffer, the commit with the new size moves it
+        if(this->resize_edges & (WLR_EDGE_TOP | WLR_EDGE_LEFT)){
+            this->grabbed_toplevel->interactive_resize(new_left, new_top, new_width, new_height);
+        } else{
+            this->grabbed_toplevel->interactive_resize(new_width, new_height);
+        }
 
         return true;
     }
@@ -97,6 +99,11 @@ void handle_cursor_button(struct wl_listener* listener,
 
     wlr_log(WLR_DEBUG, "Handling cursor button");
 
+    //the button has to land where the pointer is now
+    server->flush_pointer_motion();
+
+    input_latency_mark(server, &event->pointer->base, server->seat->pointer_state.focused_surface);
+
     utils::wake_up_from_idle(server);
 
     auto [_, input_on_surface] = utils::desktop_toplevel_at(server, server->cursor->x, server->cursor->y);
@@ -117,7 +124,7 @@ void handle_cursor_button(struct wl_listener* listener,
 
     if(event->state == WL_POINTER_BUTTON_STATE_RELEASED){
         if(cur_mouse_op != yawc_mouse_operation::NOTHING){
-            wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "default");
+            cursor_set_image(server, "default");
         }
 
         server->reset_cursor_mode();
@@ -135,6 +142,7 @@ void handle_cursor_button(struct wl_listener* listener,
 void handle_cursor_axis(struct wl_listener* listener, void* data){
     struct yawc_server *server = wl_container_of(listener, server, on_axis_cursor_motion);
     struct wlr_pointer_axis_event *event = reinterpret_cast<struct wlr_pointer_axis_event*>(data);
+    server->flush_pointer_motion();
     wlr_seat_pointer_notify_axis(server->seat, event->time_msec, event->orientation, event->delta, event->delta_discrete, event->source, event->relative_direction);
     utils::wake_up_from_idle(server);
 }
@@ -156,8 +164,9 @@ void yawc_server::handle_pointer_motion(struct wl_listener* listener, void* data
 	    wlr_cursor_absolute_to_layout_coords(this->cursor, &pointer->base,
 			motion->x, motion->y, &lx, &ly);
 
-        dx = lx - this->cursor->x;
-        dy = ly - this->cursor->y;
+        //relative to where the queued motion will leave the cursor
+        dx = lx - (this->cursor->x + this->pending_motion.dx);
+        dy = ly - (this->cursor->y + this->pending_motion.dy);
         unacc_dx = dx;
         unacc_dy = dy;
     } else {
@@ -171,14 +180,84 @@ void yawc_server::handle_pointer_motion(struct wl_listener* listener, void* data
         unacc_dy = motion->unaccel_dy;
     }
 
+    //a locked pointer doesn't move the cursor, only the client can show it
+    if(this->active_constraint && this->active_constraint->type == WLR_POINTER_CONSTRAINT_V1_LOCKED){
+        input_latency_mark(this, &pointer->base, this->active_constraint->surface);
+    } else{
+        input_latency_mark_cursor(this, &pointer->base, utils::output_at_cursor(this));
+    }
+
+    //never batched, locked pointer clients (games) want every report
 	wlr_relative_pointer_manager_v1_send_relative_motion(
 		this->relative_pointer_manager,
 		this->seat, (uint64_t)time * 1000,
 		dx, dy, unacc_dx, unacc_dy);
 
+    //a locked pointer never moves, focus stays on the locked surface until the lock goes away.
+    //nothing below (wm, hit test, seat motion) can change anything
+    if(this->active_constraint && this->active_constraint->type == WLR_POINTER_CONSTRAINT_V1_LOCKED
+            && !this->pending_motion.queued){
+        utils::wake_up_from_idle(this);
+        return;
+    }
+
+    if(!this->config->performance.pointer_coalescing){
+        process_pointer_motion(&pointer->base, dx, dy, time);
+        return;
+    }
+
+    auto *pending = &this->pending_motion;
+
+    if(pending->queued && pending->device != &pointer->base){
+        flush_pointer_motion();
+    }
+
+    pending->device = &pointer->base;
+    pending->dx += dx;
+    pending->dy += dy;
+    pending->time = time;
+    pending->queued = true;
+
+    if(!pending->idle){
+        //idle sources run once everything readable in this loop iteration was dispatched
+        pending->idle = wl_event_loop_add_idle(this->wl_event_loop, +[](void *data){
+            auto *server = static_cast<yawc_server*>(data);
+
+            server->pending_motion.idle = nullptr;
+            server->flush_pointer_motion();
+        }, this);
+    }
+}
+
+void yawc_server::flush_pointer_motion(){
+    auto *pending = &this->pending_motion;
+
+    if(pending->idle){
+        wl_event_source_remove(pending->idle);
+        pending->idle = nullptr;
+    }
+
+    if(!pending->queued){
+        return;
+    }
+
+    double dx = pending->dx, dy = pending->dy;
+
+    pending->queued = false;
+    pending->dx = pending->dy = 0;
+
+    process_pointer_motion(pending->device, dx, dy, pending->time);
+
+    if(pending->frame){
+        pending->frame = false;
+        wlr_seat_pointer_notify_frame(this->seat);
+    }
+}
+
+void yawc_server::process_pointer_motion(struct wlr_input_device *device, double dx, double dy, uint32_t time){
     handle_pointer_motion_constraint(dx, dy);
 
-    wlr_cursor_move(this->cursor, &pointer->base, dx, dy);
+    wlr_cursor_move(this->cursor, device, dx, dy);
 
     utils::wake_up_from_idle(this);
 
@@ -186,6 +265,10 @@ void yawc_server::handle_pointer_motion(struct wl_listener* listener, void* data
         return;
     }
 
+    if (content_policy_pointer_motion(this, time)) {
+        return;
+    }
+
     if(this->drag.icons){
         wlr_scene_node_set_position(&this->drag.icons->node, this->cursor->x, this->cursor->y);
     }
@@ -212,7 +295,7 @@ void yawc_server::handle_pointer_motion(struct wl_listener* listener, void* data
             input_on_surface.y);
     } else {
         wlr_seat_pointer_clear_focus(this->seat);
-        wlr_cursor_set_xcursor(this->cursor, this->cursor_mgr, "default");
+        cursor_set_image(this, "default");
     }
 }
 
@@ -240,11 +323,11 @@ void handle_request_set_cursor_shape(struct wl_listener *listener, void *data){
     const char *image = wlr_cursor_shape_v1_name(event->shape);
 
 	if (!image) {
-		wlr_cursor_unset_image(server->cursor);
+		cursor_unset_image(server);
         return;
     }
     
-	wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, image);
+	cursor_set_image(server, image);
 }
 
 void yawc_server::create_cursor()
@@ -255,6 +338,7 @@ void yawc_server::create_cursor()
     wlr_cursor_attach_output_layout(this->cursor, this->output_layout);
 
     this->cursor_mgr = wlr_xcursor_manager_create(NULL, 24);
+    cursor_preload_scale(this, 1);
 
     this->relative_pointer_manager = wlr_relative_pointer_manager_v1_create(this->wl_display);
 
@@ -274,6 +358,13 @@ void yawc_server::create_cursor()
 
     this->cursor_frame_listener.notify = +[](struct wl_listener* listener, void* data) {
         struct yawc_server* server = wl_container_of(listener, server, cursor_frame_listener);
+
+        //sent after the queued motion instead
+        if(server->pending_motion.queued){
+            server->pending_motion.frame = true;
+            return;
+        }
+
         wlr_seat_pointer_notify_frame(server->seat);
     };
     wl_signal_add(&this->cursor->events.frame, &this->cursor_frame_listener);
@@ -293,6 +384,12 @@ void yawc_server::create_cursor()
 void on_pointer_device_destroy(struct wl_listener *listener, void *data){
     struct yawc_pointer *pointer = wl_container_of(listener, pointer, destroy);
 
+    auto *pending = &pointer->server->pending_motion;
+
+    if(pending->device == pointer->wlr_device){
+        pending->device = nullptr;
+    }
+
     wl_list_remove(&pointer->destroy.link);
     wl_list_remove(&pointer->link);
 
@@ -301,6 +398,7 @@ void on_pointer_device_destroy(struct wl_listener *listener, void *data){
 
 yawc_pointer *yawc_server::handle_pointer(struct wlr_input_device *device){
     yawc_pointer *pointer = new yawc_pointer;
+    pointer->server = this;
     pointer->wlr_device = device;
 
     pointer->destroy.notify = on_pointer_device_destroy;
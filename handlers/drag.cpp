@@ -2,6 +2,7 @@
 
 #include "../server.hpp"
 #include "../utils.hpp"
+#include "../scene_descriptor.hpp"
 
 #include <assert.h>
 #include <wlr/types/wlr_data_device.h>
@@ -65,6 +66,9 @@ void yawc_server::setup_drag()
 	this->drag.icons = wlr_scene_tree_create(&this->scene->tree);
 	wlr_scene_node_set_enabled(&this->drag.icons->node, false);
 
+	//hit tests skip it through their mask instead of toggling it
+	scene_descriptor_assign(&this->drag.icons->node, YAWC_SCENE_DESC_DRAG_ICON, this, nullptr);
+
 	this->drag.events.request.notify = on_drag_request;
 	this->drag.events.start.notify = on_drag_start;
 	this->drag.events.destroy.notify = on_drag_destroy;
@@ -41,6 +41,8 @@ void handle_keyboard_input(struct wl_listener* listener,
 
     struct wlr_keyboard_key_event* event = reinterpret_cast<struct wlr_keyboard_key_event*>(data);
 
+    input_latency_mark(server, &xkeyboard->wlr_keyboard->base, server->seat->keyboard_state.focused_surface);
+
     uint32_t keycode = event->keycode + 8;
     
     const xkb_keysym_t sym = xkb_state_key_get_one_sym(xkeyboard->wlr_keyboard->xkb_state, keycode);
@@ -73,11 +75,11 @@ void handle_keyboard_input(struct wl_listener* listener,
     }
 
     if(server->keybind_manager->needed()){
-        server->keybind_manager->store(sym, modifiers, event->state == WL_KEYBOARD_KEY_STATE_PRESSED);
+        server->keybind_manager->store(keycode, sym, modifiers, event->state == WL_KEYBOARD_KEY_STATE_PRESSED);
 
         struct yawc_bind_node *keybind;
         if((keybind = server->keybind_manager->triggered())){
-            server->keybind_manager->execute_action(keybind, sym);
+            server->keybind_manager->execute_action(keybind, keycode);
             return;
         }
 
@@ -161,23 +163,9 @@ void yawc_server::load_keyboard_cfg(yawc_keyboard *keyboard){
         return;
     }
 
-    struct xkb_rule_names rules; 
-
-    rules.layout = config.xkb_layout.has_value() ? config.xkb_layout->c_str() : nullptr;
-    rules.model = config.xkb_model.has_value() ? config.xkb_model->c_str() : nullptr;
-    rules.options = config.xkb_options.has_value() ? config.xkb_options->c_str() : nullptr;
-    rules.rules = config.xkb_rules.has_value() ? config.xkb_rules->c_str() : nullptr;
-    rules.variant = config.xkb_variant.has_value() ? config.xkb_variant->c_str() : nullptr;
-        
 	wlr_keyboard_set_repeat_info(keyboard->wlr_keyboard, 
             config.repeat_rate.value_or(25), 
             config.repeat_delay.value_or(600));
 
-    struct xkb_context* context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-    struct xkb_keymap* keymap = xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
-
-    wlr_keyboard_set_keymap(keyboard->wlr_keyboard, keymap);
-
-    xkb_keymap_unref(keymap);
-    xkb_context_unref(context);
+    keymap_cache_apply(this, keyboard, config);
 }
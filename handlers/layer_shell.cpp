@@ -135,6 +135,7 @@ void arrange_surface(struct yawc_output *output, const struct wlr_box *full_area
 		}
 
 		wlr_scene_layer_surface_v1_configure(surface->scene, full_area, usable_area);
+		hit_index_update(output->server, &surface->tree->node);
 	}
 }
 
@@ -228,6 +229,7 @@ void handle_layer_surface_commit(struct wl_listener *listener, void *data) {
         enum zwlr_layer_shell_v1_layer layer_type = layer_surface->current.layer;
         struct wlr_scene_tree *output_layer = layer_get_scene(server, layer_type);
         wlr_scene_node_reparent(&surface->scene->tree->node, output_layer);
+        hit_index_update(server, &surface->scene->tree->node);
     }
 
     if (layer_surface->initial_commit || committed || 
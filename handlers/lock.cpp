@@ -35,6 +35,7 @@ void lock_output_reconfigure(struct yawc_session_lock_output *output) {
 
 	wlr_log(WLR_ERROR, "Ok so width: %i, height: %i", width, height);
 	wlr_scene_rect_set_size(output->background, width, height);
+	hit_index_update(output->server, &output->tree->node);
 
 	if (output->surface) {
 		wlr_session_lock_surface_v1_configure(output->surface, width, height);
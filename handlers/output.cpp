@@ -1,9 +1,14 @@
+#include <algorithm>
 #include <tuple>
+#include <vector>
 
 #include "../lock.hpp"
 #include "../toplevel.hpp"
 #include "../layer.hpp"
 #include "../utils.hpp"
+#include "../frame_scheduler.hpp"
+#include "../resolution_governor.hpp"
+#include "../cursor_image.hpp"
 
 void reorganize_toplevels(struct yawc_server *sv, struct wlr_output *old_output){
     bool found = false;
@@ -45,73 +50,106 @@ void reorganize_toplevels(struct yawc_server *sv, struct wlr_output *old_output)
         }
 
         wlr_scene_node_set_position(&toplevel->scene_tree->node, dest_x, dest_y);
+        hit_index_update(sv, &toplevel->scene_tree->node);
     }
-}
 
-bool apply_output_config(struct yawc_server *server,
-        struct wlr_output_configuration_head_v1 *head, 
-        struct wlr_output *output, 
-        struct wlr_output_layout *output_layout,
-        bool only_test){
-    if(output == server->fallback_output->wlr_output){
-        wlr_log(WLR_INFO, "Tried to apply a config to the fallback output, skipped");
-        return true;
-    }
+    utils::update_output_occupants(sv);
+}
 
-    struct wlr_output_head_v1_state *state = &head->state;
-    struct wlr_output_state pending;
+//one state per head, the fallback output never takes part
+std::vector<struct wlr_backend_output_state> build_output_states(struct yawc_server *server,
+        struct wlr_output_configuration_v1 *config){
+    std::vector<struct wlr_backend_output_state> states;
 
-    wlr_output_state_init(&pending);
+    struct wlr_output_configuration_head_v1 *head;
+    wl_list_for_each(head, &config->heads, link){
+        if(head->state.output == server->fallback_output->wlr_output){
+            wlr_log(WLR_INFO, "Tried to apply a config to the fallback output, skipped");
+            continue;
+        }
 
-    wlr_output_state_set_enabled(&pending, state->enabled);
+        struct wlr_backend_output_state state = {};
+        state.output = head->state.output;
 
-    if(state->enabled){
-        if(state->mode){
-            wlr_output_state_set_mode(&pending, state->mode);
-        } else if(state->custom_mode.width || state->custom_mode.height){
-            wlr_output_state_set_custom_mode(&pending, state->custom_mode.width, state->custom_mode.height, state->custom_mode.refresh);
-        }
+        wlr_output_state_init(&state.base);
+        wlr_output_head_v1_state_apply(&head->state, &state.base);
 
-        if(state->scale > 0){
-            wlr_output_state_set_scale(&pending, state->scale);
-        }
+        states.push_back(state);
+    }
 
-        wlr_output_state_set_adaptive_sync_enabled(&pending, state->adaptive_sync_enabled);
+    return states;
+}
 
-        wlr_output_state_set_transform(&pending, state->transform);
+void finish_output_states(std::vector<struct wlr_backend_output_state> &states){
+    for(auto &state: states){
+        wlr_output_state_finish(&state.base);
     }
+}
+
+bool apply_output_configuration(struct yawc_server *server,
+        struct wlr_output_configuration_v1 *config, 
+        bool only_test){
+    auto states = build_output_states(server, config);
 
-    bool ok = wlr_output_test_state(output, &pending);
+    //a single test and a single commit for every output, so it either all happens or nothing does
+    bool ok = wlr_backend_test(server->backend, states.data(), states.size());
 
-    if(only_test){
-        wlr_output_state_finish(&pending);
-        return ok;
+    if(ok && !only_test){
+        ok = wlr_backend_commit(server->backend, states.data(), states.size());
     }
 
-    ok = wlr_output_commit_state(output, &pending);
-    wlr_output_state_finish(&pending);
+    finish_output_states(states);
 
-    if(!ok){
+    if(!ok || only_test){
         return ok;
     }
 
-    if(state->enabled){
+    struct wlr_output_configuration_head_v1 *head;
+
+    //layout and scene once everything is committed, new positions first so relocation lands right
+    wl_list_for_each(head, &config->heads, link){
+        struct wlr_output *output = head->state.output;
+
+        if(output == server->fallback_output->wlr_output || !head->state.enabled){
+            continue;
+        }
+
+        struct yawc_output *youtput = reinterpret_cast<struct yawc_output*>(output->data);
+
+        if(youtput->mirror_source){
+            continue; //mirror targets stay out of the layout
+        }
+
+        bool in_layout = wlr_output_layout_get(server->output_layout, output) != nullptr;
+
+        //placed now, the hotplug batch must not move it again
+        youtput->pending_layout = false;
+
         struct wlr_output_layout_output *olo;
 
-        if(state->x != INT_MAX && state->y != INT_MAX){
-            olo = wlr_output_layout_add(output_layout, output, state->x, state->y); 
+        if(head->state.x != INT_MAX && head->state.y != INT_MAX){
+            olo = wlr_output_layout_add(server->output_layout, output, head->state.x, head->state.y); 
         } else{
-            olo = wlr_output_layout_add_auto(output_layout, output);
+            olo = wlr_output_layout_add_auto(server->output_layout, output);
         }
 
-        struct yawc_output *youtput = reinterpret_cast<struct yawc_output*>(output->data);
+        if(!in_layout){
+            wlr_scene_output_layout_add_output(server->scene_layout, olo,
+                youtput->scene_output);
+        }
+    }
 
-        wlr_scene_output_layout_add_output(server->scene_layout, olo,
-            youtput->scene_output);
-    } else{
-        wlr_output_layout_remove(output_layout, output);
+    wl_list_for_each(head, &config->heads, link){
+        struct wlr_output *output = head->state.output;
 
+        if(output == server->fallback_output->wlr_output || head->state.enabled){
+            continue;
+        }
+
+        //still in the layout, so its toplevels can be found
         reorganize_toplevels(server, output);
+
+        wlr_output_layout_remove(server->output_layout, output);
     }
 
     return ok;
@@ -148,38 +186,159 @@ void update_output_manager_config(struct yawc_server *server) {
     wlr_output_manager_v1_set_configuration(server->output_manager, cfg);
 }
 
-void handle_output_manager_apply(struct wl_listener *listener, void *data){
-    struct yawc_server *server = wl_container_of(listener, server, output_manager_apply);
-    struct wlr_output_configuration_v1 *config = reinterpret_cast<struct wlr_output_configuration_v1*>(data);
+struct yawc_output *find_mirror_source(struct yawc_output *output){
+    auto *server = output->server;
+    auto &name = output->config.mirror;
 
-    struct wlr_output_configuration_head_v1 *head;
+    if(!name || *name == output->wlr_output->name){
+        return nullptr;
+    }
+
+    struct yawc_output *source;
+    wl_list_for_each(source, &server->outputs, link){
+        //no chains, a source always composes its own scene
+        if(source == server->fallback_output || source->config.mirror || *name != source->wlr_output->name){
+            continue;
+        }
+
+        return source->wlr_output->enabled ? source : nullptr;
+    }
 
-    bool ok = true;
+    return nullptr;
+}
 
-    wl_list_for_each(head, &config->heads, link) {
-        if (!(ok = apply_output_config(server, head, head->state.output, server->output_layout, true))) {
-            break;
+bool output_has_mirrors(struct yawc_output *output){
+    struct yawc_output *target;
+    wl_list_for_each(target, &output->server->outputs, link){
+        if(target->mirror_source == output){
+            return true;
         }
     }
 
-    if (!ok) {
-        wlr_output_configuration_v1_send_failed(config);
-        wlr_output_configuration_v1_destroy(config);
+    return false;
+}
+
+void output_release_mirror_buffer(struct yawc_output *output){
+    if(output->mirror_buffer){
+        wlr_buffer_unlock(output->mirror_buffer);
+        output->mirror_buffer = nullptr;
+    }
+}
+
+//hardware cursor planes aren't in the buffer the targets copy
+void output_update_mirror_cursor_lock(struct yawc_output *output){
+    bool mirrored = output_has_mirrors(output);
+
+    if(mirrored == output->mirror_cursor_locked){
         return;
     }
 
-    wl_list_for_each(head, &config->heads, link) {
-        if (!(ok = apply_output_config(server, head, head->state.output, server->output_layout, false))) {
-            wlr_log(WLR_ERROR, "Failed to apply config for output %s",
-                    head->state.output ? head->state.output->name : "(unknown)");
+    wlr_output_lock_software_cursors(output->wlr_output, mirrored);
+    output->mirror_cursor_locked = mirrored;
+}
+
+void output_update_mirroring(struct yawc_output *output){
+    auto *server = output->server;
+    auto *source = find_mirror_source(output);
+    auto *old_source = output->mirror_source;
+
+    output->mirror_source = source;
+    output->mirror_seq_shown = 0;
+
+    if(source && output->scene_output){
+        //its windows go elsewhere and the scene stops composing for it
+        reorganize_toplevels(server, output->wlr_output);
+
+        wlr_output_layout_remove(server->output_layout, output->wlr_output);
+
+        wlr_scene_output_destroy(output->scene_output);
+        output->scene_output = nullptr;
+        output->pending_layout = false;
+
+        resolution_governor_finish(output);
+
+        wlr_log(WLR_INFO, "Mirroring %s on %s", source->wlr_output->name, output->wlr_output->name);
+    } else if(!source && !output->scene_output){
+        output->scene_output = wlr_scene_output_create(server->scene, output->wlr_output);
+        output->pending_layout = true;
+
+        wlr_log(WLR_INFO, "Stopped mirroring on %s", output->wlr_output->name);
+    }
+
+    if(old_source && old_source != source){
+        output_update_mirror_cursor_lock(old_source);
+    }
+
+    if(source){
+        output_update_mirror_cursor_lock(source);
+        wlr_output_schedule_frame(source->wlr_output);
+    }
+
+    if(!output_has_mirrors(output)){
+        output_release_mirror_buffer(output);
+    }
+}
+
+void flush_output_topology(struct yawc_server *server){
+    struct yawc_output *output;
+    wl_list_for_each(output, &server->outputs, link){
+        if(output != server->fallback_output){
+            output_update_mirroring(output);
         }
     }
 
-    if (ok) {
+    wl_list_for_each(output, &server->outputs, link){
+        if(!output->pending_layout){
+            continue;
+        }
+
+        output->pending_layout = false;
+
+        if(wlr_output_layout_get(server->output_layout, output->wlr_output)){
+            continue;
+        }
+
+        auto *output_layout_output = wlr_output_layout_add_auto(server->output_layout, output->wlr_output);
+
+        wlr_scene_output_layout_add_output(server->scene_layout, output_layout_output,
+            output->scene_output);
+    }
+
+    reorganize_toplevels(server, nullptr);
+
+    update_output_manager_config(server);
+}
+
+int handle_hotplug_timer(void *data){
+    flush_output_topology(static_cast<struct yawc_server*>(data));
+
+    return 0;
+}
+
+//docks fire a burst of new_output/destroy events, only relayout once they calm down
+void schedule_output_topology_update(struct yawc_server *server){
+    int32_t debounce = server->config->performance.hotplug_debounce_ms;
+
+    if(debounce <= 0 || !server->hotplug_timer){
+        flush_output_topology(server);
+        return;
+    }
+
+    wl_event_source_timer_update(server->hotplug_timer, debounce);
+}
+
+void handle_output_manager_apply(struct wl_listener *listener, void *data){
+    struct yawc_server *server = wl_container_of(listener, server, output_manager_apply);
+    struct wlr_output_configuration_v1 *config = reinterpret_cast<struct wlr_output_configuration_v1*>(data);
+
+    if (apply_output_configuration(server, config, false)) {
         wlr_output_configuration_v1_send_succeeded(config);
 
-        update_output_manager_config(server);
+        //mirrors follow their source being turned on or off
+        flush_output_topology(server);
     } else {
+        wlr_log(WLR_ERROR, "Failed to apply an output configuration, nothing changed");
+
         wlr_output_configuration_v1_send_failed(config);
     }
 
@@ -190,18 +349,14 @@ void handle_output_manager_test(struct wl_listener *listener, void *data){
     struct yawc_server *server = wl_container_of(listener, server, output_manager_test);
     struct wlr_output_configuration_v1 *config = reinterpret_cast<struct wlr_output_configuration_v1*>(data);
 
-    struct wlr_output_configuration_head_v1 *head;
+    if (apply_output_configuration(server, config, true)) {
+        wlr_output_configuration_v1_send_succeeded(config);
+    } else {
+        wlr_log(WLR_ERROR, "Output configuration test failed");
 
-    wl_list_for_each(head, &config->heads, link) {
-        if(!apply_output_config(server, head, head->state.output, server->output_layout, true)){
-            wlr_log(WLR_ERROR, "Failed to apply config test for output %s", head->state.output->name);
-            wlr_output_configuration_v1_send_failed(config);
-            wlr_output_configuration_v1_destroy(config);
-            return;
-        }
+        wlr_output_configuration_v1_send_failed(config);
     }
 
-    wlr_output_configuration_v1_send_succeeded(config);
     wlr_output_configuration_v1_destroy(config);
 }
 
@@ -209,10 +364,17 @@ void output_commit(struct wl_listener* listener, void* data){
     struct yawc_output *output = wl_container_of(listener, output, commit);
     struct wlr_output_event_commit *event = static_cast<struct wlr_output_event_commit*>(data);
 
+    if (event->state->committed & WLR_OUTPUT_STATE_MODE){
+        output->tearing = TEARING_UNKNOWN;
+    }
+
     if (!(event->state->committed & (WLR_OUTPUT_STATE_MODE | WLR_OUTPUT_STATE_SCALE | WLR_OUTPUT_STATE_TRANSFORM))){
         return;
     }
 
+    //the reduced buffer no longer matches, start over from native
+    resolution_governor_finish(output);
+
     int width = 0, height = 0;
     wlr_output_effective_resolution(output->wlr_output, &width, &height);
     
@@ -226,6 +388,10 @@ void output_commit(struct wl_listener* listener, void* data){
         output->last_height = height;
         output->last_scale = scale;
 
+        if(scale_changed){
+            cursor_preload_scale(output->server, scale);
+        }
+
         arrange_layers(output);
         arrange_locks(output->server);
 
@@ -241,45 +407,266 @@ void output_commit(struct wl_listener* listener, void* data){
     }
 } 
 
-void render_frame(struct wl_listener* listener, void* data){
-    struct yawc_output* output = wl_container_of(listener, output, frame);
+static bool output_wants_tearing(struct yawc_output *output){
+    if(output->tearing == TEARING_UNSUPPORTED || !output->config.allow_tearing.value_or(true)){
+        return false;
+    }
+
+    auto *toplevel = output->occupant;
+
+    if(!toplevel || !toplevel->mapped){
+        return false;
+    }
+
+    if(output->policy && output->policy->allow_tearing.has_value()){
+        return *output->policy->allow_tearing;
+    }
+
+    auto hint = wlr_tearing_control_manager_v1_surface_hint_from_surface(
+        output->server->tearing_control_manager, toplevel->xdg_toplevel->base->surface);
+
+    return hint == WP_TEARING_CONTROL_V1_PRESENTATION_HINT_ASYNC;
+}
+
+//one scaled blit of the source frame instead of a composition of our own
+void output_render_mirror(struct yawc_output *output){
+    auto *source = output->mirror_source;
+    auto *wlr_output = output->wlr_output;
+    auto *buffer = source->mirror_buffer;
+
+    if(!buffer || source->mirror_seq == output->mirror_seq_shown){
+        return;
+    }
+
+    auto transform = wlr_output_transform_compose(source->wlr_output->transform,
+        wlr_output_transform_invert(wlr_output->transform));
+
+    int src_width = buffer->width, src_height = buffer->height;
+
+    if(transform & WL_OUTPUT_TRANSFORM_90){
+        std::swap(src_width, src_height);
+    }
+
+    //fit and center, a 16:10 panel on a 16:9 projector gets bars instead of stretching
+    double ratio = std::min((double)wlr_output->width / src_width, (double)wlr_output->height / src_height);
+
+    struct wlr_box dst;
+    dst.width = src_width * ratio;
+    dst.height = src_height * ratio;
+    dst.x = (wlr_output->width - dst.width) / 2;
+    dst.y = (wlr_output->height - dst.height) / 2;
+
+    struct wlr_texture *texture = wlr_texture_from_buffer(output->server->renderer, buffer);
+
+    if(!texture){
+        return;
+    }
+
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+
+    struct wlr_render_pass *pass = wlr_output_begin_render_pass(wlr_output, &state, NULL);
+
+    if(!pass){
+        wlr_output_state_finish(&state);
+        wlr_texture_destroy(texture);
+        return;
+    }
+
+    struct wlr_render_rect_options clear = {};
+    clear.box = {0, 0, wlr_output->width, wlr_output->height};
+    clear.color = {0, 0, 0, 1};
+
+    wlr_render_pass_add_rect(pass, &clear);
+
+    struct wlr_render_texture_options options = {};
+    options.texture = texture;
+    options.dst_box = dst;
+    options.transform = transform;
+    options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+
+    wlr_render_pass_add_texture(pass, &options);
+
+    if(wlr_render_pass_submit(pass) && wlr_output_commit_state(wlr_output, &state)){
+        output->mirror_seq_shown = source->mirror_seq;
+    }
+
+    wlr_output_state_finish(&state);
+    wlr_texture_destroy(texture);
+}
+
+void output_render(struct yawc_output *output){
     auto *scene_output = output->scene_output;
 
-    if(!wlr_scene_output_needs_frame(scene_output)){
+    if(output->mirror_source && output->wlr_output->enabled){
+        output_render_mirror(output);
+        return;
+    }
+
+    if(!scene_output || !output->wlr_output->enabled){
+        return;
+    }
+
+    int64_t start = utils::now_ns();
+
+    auto *render_scene_output = resolution_governor_active(output) ? output->governor.shadow_scene_output : scene_output;
+    bool damage_whole = output->damage_whole;
+
+    bool needs_frame = damage_whole || wlr_scene_output_needs_frame(scene_output)
+        || (resolution_governor_active(output) && wlr_scene_output_needs_frame(output->governor.shadow_scene_output));
+
+    int64_t build_start = utils::now_ns();
+    frame_stats_record(output, YAWC_METRIC_NEEDS_FRAME, start, build_start);
+
+    if(!needs_frame){
         struct timespec now;
         clock_gettime(CLOCK_MONOTONIC, &now);
         wlr_scene_output_send_frame_done(scene_output, &now);
         return;
     }
 
+    if(damage_whole){
+        //the ring decides what gets rendered into each buffer
+        struct wlr_box box = {0, 0, render_scene_output->output->width, render_scene_output->output->height};
+        wlr_damage_ring_add_box(&render_scene_output->damage_ring, &box);
+    }
+
     struct wlr_output_state state;
     wlr_output_state_init(&state);
 
-	if (!wlr_scene_output_build_state(scene_output, &state, NULL)) {
+    bool built = resolution_governor_active(output) 
+        ? resolution_governor_build_state(output, &state)
+        : wlr_scene_output_build_state(scene_output, &state, NULL);
+
+	if (!built) {
 		wlr_output_state_finish(&state);
 		return;
 	}
 
-    state.tearing_page_flip = true;
+    if(damage_whole && state.buffer){
+        output->damage_whole = false;
+
+        pixman_region32_t full;
+        pixman_region32_init_rect(&full, 0, 0, output->wlr_output->width, output->wlr_output->height);
+        wlr_output_state_set_damage(&state, &full);
+        pixman_region32_fini(&full);
+    }
+
+    damage_debug_frame(output, &state);
+
+    int64_t commit_start = utils::now_ns();
+    frame_stats_record(output, YAWC_METRIC_BUILD_STATE, build_start, commit_start);
+
+    bool result = false;
+    int64_t commit_end = commit_start;
+
+    //property changes can't go through an async flip
+    bool adaptive_sync_change = output->pending_adaptive_sync.has_value();
+
+    if(adaptive_sync_change){
+        wlr_output_state_set_adaptive_sync_enabled(&state, *output->pending_adaptive_sync);
+        output->pending_adaptive_sync.reset();
+    }
+
+    if(!adaptive_sync_change && output_wants_tearing(output)){
+        state.tearing_page_flip = true;
+
+        result = wlr_output_commit_state(output->wlr_output, &state);
 
-    bool result = wlr_output_commit_state(output->wlr_output, &state);
+        commit_end = utils::now_ns();
+        frame_stats_record(output, YAWC_METRIC_COMMIT_TEARING, commit_start, commit_end);
+
+        if(output->tearing == TEARING_UNKNOWN){
+            //only blame the async flip if the same frame would go through with vsync
+            if(result){
+                output->tearing = TEARING_SUPPORTED;
+            } else{
+                state.tearing_page_flip = false;
+
+                if(wlr_output_test_state(output->wlr_output, &state)){
+                    wlr_log(WLR_INFO, "Output %s doesn't support tearing", output->wlr_output->name);
+                    output->tearing = TEARING_UNSUPPORTED;
+                }
+            }
+        }
+    }
  
     if(!result){
         state.tearing_page_flip = false;
+
+        commit_start = commit_end;
         result = wlr_output_commit_state(output->wlr_output, &state);
+
+        commit_end = utils::now_ns();
+        frame_stats_record(output, YAWC_METRIC_COMMIT_VSYNC, commit_start, commit_end);
     }
 
     if (!result) {
         wlr_log(WLR_DEBUG, "Failed to commit state");
+    } else{
+        output->stats.commit_ns = commit_end;
+        input_latency_committed(output);
+
+        resolution_governor_committed(output, start, commit_end);
+
+        if(state.buffer && output_has_mirrors(output)){
+            output_release_mirror_buffer(output);
+
+            output->mirror_buffer = wlr_buffer_lock(state.buffer);
+            output->mirror_seq++;
+
+            struct yawc_output *target;
+            wl_list_for_each(target, &output->server->outputs, link){
+                if(target->mirror_source == output){
+                    wlr_output_schedule_frame(target->wlr_output);
+                }
+            }
+        }
     }
 
     wlr_output_state_finish(&state);
+
+    frame_scheduler_record(output, start, commit_end);
     
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
     wlr_scene_output_send_frame_done(scene_output, &now);
 }
 
+void render_frame(struct wl_listener* listener, void* data){
+    struct yawc_output* output = wl_container_of(listener, output, frame);
+
+    //with resize_configure_per_frame the newest interactive size waits for a frame of
+    //the window's output, so the client gets at most one configure per refresh
+    auto *grabbed = output->server->grabbed_toplevel;
+    if(grabbed && grabbed->resize.pending && !grabbed->resize_in_flight()
+            && utils::get_output_of_toplevel(grabbed) == output){
+        grabbed->flush_interactive_resize();
+    }
+
+    if(frame_scheduler_delay(output)){
+        return;
+    }
+
+    output_render(output);
+}
+
+void output_present(struct wl_listener *listener, void *data){
+    struct yawc_output *output = wl_container_of(listener, output, present);
+    struct wlr_output_event_present *event = static_cast<struct wlr_output_event_present*>(data);
+
+    frame_scheduler_presented(output, event);
+    resolution_governor_presented(output, event);
+
+    if(event->presented && output->stats.commit_ns){
+        frame_stats_record(output, YAWC_METRIC_PRESENT, output->stats.commit_ns, utils::timespec_to_ns(event->when));
+    }
+
+    input_latency_presented(output, event);
+
+    output->stats.commit_ns = 0;
+}
+
 void request_state(struct wl_listener *listener, void *data){
     struct yawc_output* output = wl_container_of(listener, output, request_state);
     struct wlr_output_event_request_state* event = reinterpret_cast<struct wlr_output_event_request_state*>(data);
@@ -297,9 +684,30 @@ void destroy_output(struct wl_listener *listener, void *data){
     wl_list_remove(&output->commit.link);
     wl_list_remove(&output->frame.link);
     wl_list_remove(&output->request_state.link);
+    wl_list_remove(&output->present.link);
     wl_list_remove(&output->destroy.link);
     wl_list_remove(&output->link);
 
+    frame_scheduler_finish(output);
+    resolution_governor_finish(output);
+    frame_stats_finish(output);
+
+    struct yawc_output *target;
+    wl_list_for_each(target, &server->outputs, link){
+        if(target->mirror_source == output){
+            target->mirror_source = nullptr;
+        }
+    }
+
+    output_release_mirror_buffer(output);
+
+    if(output->mirror_source){
+        output_update_mirror_cursor_lock(output->mirror_source);
+    }
+
+    //virtual outputs can also go away with the backend
+    std::erase(server->virtual_outputs, output->wlr_output);
+
 	wlr_scene_output_destroy(output->scene_output);
 	output->scene_output = NULL;
 
@@ -313,9 +721,7 @@ void destroy_output(struct wl_listener *listener, void *data){
 
     delete output; 
 
-    update_output_manager_config(server);
-
-    reorganize_toplevels(server, nullptr);
+    schedule_output_topology_update(server);
 }
 
 void handle_output_power_manager_set_mode(struct wl_listener *listener,
@@ -362,6 +768,12 @@ bool setup_new_output_state(struct wlr_output *output){
     return ret;
 }
 
+void yawc_server::load_output_cfg(yawc_output *output){
+    output->config = this->config->get_output_config(output->wlr_output->name);
+
+    output->tearing = TEARING_UNKNOWN;
+}
+
 void yawc_server::handle_new_output(struct wl_listener* listener, void* data){
     struct wlr_output* wlr_output = reinterpret_cast<struct wlr_output*>(data);
 
@@ -370,6 +782,10 @@ void yawc_server::handle_new_output(struct wl_listener* listener, void* data){
 		return;
 	}
 
+    if (this->creating_shadow_output) {
+        return;
+    }
+
     wlr_log(WLR_DEBUG, "Initiating render for output");
 
     if(!wlr_output_init_render(wlr_output, this->allocator, this->renderer)){
@@ -408,6 +824,14 @@ void yawc_server::handle_new_output(struct wl_listener* listener, void* data){
     output->request_state.notify = request_state; 
     wl_signal_add(&wlr_output->events.request_state, &output->request_state);
 
+    output->present.notify = output_present;
+    wl_signal_add(&wlr_output->events.present, &output->present);
+
+    this->load_output_cfg(output);
+    frame_scheduler_init(output);
+
+    cursor_preload_scale(this, wlr_output->scale > 0 ? wlr_output->scale : 1);
+
     output->destroy.notify = destroy_output;
     wl_signal_add(&wlr_output->events.destroy, &output->destroy);
 
@@ -415,12 +839,10 @@ void yawc_server::handle_new_output(struct wl_listener* listener, void* data){
         session_lock_output_create(this, output);
     }
 
-    auto *output_layout_output = wlr_output_layout_add_auto(this->output_layout, wlr_output);
+    //joins the layout with the rest of the batch
+    output->pending_layout = true;
 
-    wlr_scene_output_layout_add_output(this->scene_layout, output_layout_output,
-        scene_output);
-
-    update_output_manager_config(this);
+    schedule_output_topology_update(this);
 }
 
 void on_output_manager_destroy(struct wl_listener *listener, void *data){
@@ -465,6 +887,8 @@ yawc_server_error yawc_server::handle_outputs()
     this->output_manager_destroy.notify = on_output_manager_destroy;
     wl_signal_add(&this->output_manager->events.destroy, &this->output_manager_destroy);
 
+    this->hotplug_timer = wl_event_loop_add_timer(this->wl_event_loop, handle_hotplug_timer, this);
+
     update_output_manager_config(this);
 
     return yawc_server_error::OK;
@@ -2,6 +2,7 @@
 
 #include "../toplevel.hpp"
 #include "../utils.hpp"
+#include "../cursor_image.hpp"
 
 void handle_pointer_focus_change(struct wl_listener* listener, void* data){
     struct yawc_server* server = wl_container_of(listener, server, on_pointer_focus_change);
@@ -9,7 +10,7 @@ void handle_pointer_focus_change(struct wl_listener* listener, void* data){
     struct wlr_seat_pointer_focus_change_event* event = reinterpret_cast<struct wlr_seat_pointer_focus_change_event*>(data);
 
     if (event->new_surface == NULL) {
-        wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "default");
+        cursor_set_image(server, "default");
     }
 }
 
@@ -28,7 +29,7 @@ void handle_seat_request_cursor(struct wl_listener* listener, void* data){
 		 * provided surface as the cursor image. It will set the hardware cursor
 		 * on the output that it's currently on and continue to do so as the
 		 * cursor moves between outputs. */
-		wlr_cursor_set_surface(server->cursor, event->surface,
+		cursor_set_surface(server, event->surface,
 				event->hotspot_x, event->hotspot_y);
 	}
 }
@@ -149,6 +150,8 @@ void yawc_server::handle_new_input(struct wl_listener* listener, void* data){
 
     struct wlr_input_device* input = reinterpret_cast<struct wlr_input_device*>(data);
 
+    input_trace_record_device(this, input);
+
     if (input->type == WLR_INPUT_DEVICE_KEYBOARD) {
 		yawc_keyboard *keyboard = this->handle_keyboard(input);
 		this->load_keyboard_cfg(keyboard);
@@ -276,7 +276,7 @@ void yawc_server::create_xdg_shell()
 {
     wlr_log(WLR_DEBUG, "Initializing toplevels");
 
-    this->xdg_shell = wlr_xdg_shell_create(this->wl_display, 5);
+    this->xdg_shell = wlr_xdg_shell_create(this->wl_display, 6);
 
     this->new_xdg_toplevel_listener.notify = handle_new_toplevel;
     wl_signal_add(&this->xdg_shell->events.new_toplevel,
@@ -0,0 +1,499 @@
+#include "server.hpp"
+
+#include "layer.hpp"
+#include "scene_descriptor.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+struct yawc_hit_surface {
+    struct yawc_server *server;
+    struct wlr_surface *surface;
+
+    struct wl_listener commit;
+    struct wl_listener destroy;
+};
+
+uint64_t cell_key(int cx, int cy){
+    return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+}
+
+bool is_layer_tree(struct yawc_server *server, struct wlr_scene_tree *tree){
+    auto &l = server->layers;
+
+    return tree == l.background || tree == l.bottom || tree == l.normal || tree == l.top
+        || tree == l.fullscreen || tree == l.unmanaged || tree == l.overlay || tree == l.screenlock;
+}
+
+struct wlr_scene_node *entry_root_of(struct yawc_server *server, struct wlr_scene_node *node){
+    while(node && node->parent){
+        if(is_layer_tree(server, node->parent)){
+            return node;
+        }
+
+        node = &node->parent->node;
+    }
+
+    return nullptr;
+}
+
+//the scene tree a client surface lives in, if we made one for it
+struct wlr_scene_node *surface_scene_node(struct wlr_surface *surface){
+    surface = wlr_surface_get_root_surface(surface);
+
+    if(struct wlr_xdg_surface *xdg_surface = wlr_xdg_surface_try_from_wlr_surface(surface)){
+        if(xdg_surface->data){
+            return &static_cast<struct wlr_scene_tree*>(xdg_surface->data)->node;
+        }
+
+        //layer shell popups don't set it, their parent does
+        if(xdg_surface->role == WLR_XDG_SURFACE_ROLE_POPUP && xdg_surface->popup->parent){
+            return surface_scene_node(xdg_surface->popup->parent);
+        }
+
+        return nullptr;
+    }
+
+    if(struct wlr_layer_surface_v1 *layer = wlr_layer_surface_v1_try_from_wlr_surface(surface)){
+        if(layer->data){
+            return &static_cast<struct yawc_layer_surface*>(layer->data)->tree->node;
+        }
+    }
+
+    return nullptr;
+}
+
+void extend_box(struct wlr_scene_node *node, int lx, int ly, struct yawc_hit_entry *entry){
+    lx += node->x;
+    ly += node->y;
+
+    if(node->type == WLR_SCENE_NODE_TREE){
+        struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+
+        struct wlr_scene_node *child;
+        wl_list_for_each(child, &tree->children, link){
+            extend_box(child, lx, ly, entry);
+        }
+
+        return;
+    }
+
+    int width, height;
+    wlr_scene_node_get_size(node, &width, &height);
+
+    if(width <= 0 || height <= 0){
+        return;
+    }
+
+    entry->x1 = std::min(entry->x1, lx);
+    entry->y1 = std::min(entry->y1, ly);
+    entry->x2 = std::max(entry->x2, lx + width);
+    entry->y2 = std::max(entry->y2, ly + height);
+}
+
+template<typename F>
+void for_each_cell(struct yawc_hit_entry *entry, F &&fn){
+    int shift = yawc_hit_index::CELL_SHIFT;
+
+    for(int cy = entry->y1 >> shift; cy <= (entry->y2 - 1) >> shift; ++cy){
+        for(int cx = entry->x1 >> shift; cx <= (entry->x2 - 1) >> shift; ++cx){
+            fn(cell_key(cx, cy));
+        }
+    }
+}
+
+bool entry_oversized(struct yawc_hit_entry *entry){
+    int shift = yawc_hit_index::CELL_SHIFT;
+
+    int64_t columns = ((entry->x2 - 1) >> shift) - (entry->x1 >> shift) + 1;
+    int64_t rows = ((entry->y2 - 1) >> shift) - (entry->y1 >> shift) + 1;
+
+    return columns * rows > yawc_hit_index::MAX_CELLS;
+}
+
+void entry_remove_from_cells(struct yawc_hit_entry *entry){
+    auto *index = entry->index;
+
+    if(!entry->placed){
+        return;
+    }
+
+    entry->placed = false;
+
+    if(entry_oversized(entry)){
+        std::erase(index->oversized, entry);
+        return;
+    }
+
+    for_each_cell(entry, [&](uint64_t key){
+        auto it = index->cells.find(key);
+
+        if(it == index->cells.end()){
+            return;
+        }
+
+        std::erase(it->second, entry);
+
+        if(it->second.empty()){
+            index->cells.erase(it);
+        }
+    });
+}
+
+void entry_refresh(struct yawc_hit_entry *entry){
+    auto *index = entry->index;
+
+    entry_remove_from_cells(entry);
+
+    entry->dirty = false;
+
+    int px = 0, py = 0;
+    wlr_scene_node_coords(&entry->node->parent->node, &px, &py);
+
+    entry->x1 = entry->y1 = INT_MAX;
+    entry->x2 = entry->y2 = INT_MIN;
+
+    extend_box(entry->node, px, py, entry);
+
+    if(entry->x1 >= entry->x2 || entry->y1 >= entry->y2){
+        return;
+    }
+
+    entry->placed = true;
+
+    if(entry_oversized(entry)){
+        index->oversized.push_back(entry);
+        return;
+    }
+
+    for_each_cell(entry, [&](uint64_t key){
+        index->cells[key].push_back(entry);
+    });
+}
+
+void handle_hit_entry_destroy(struct wl_listener *listener, void *data){
+    struct yawc_hit_entry *entry = wl_container_of(listener, entry, destroy);
+    auto *index = entry->index;
+
+    entry_remove_from_cells(entry);
+
+    std::erase(index->dirty, entry);
+    index->entries.erase(entry->node);
+
+    index->generation++;
+
+    wl_list_remove(&entry->destroy.link);
+
+    delete entry;
+}
+
+void hit_index_update(struct yawc_server *server, struct wlr_scene_node *node){
+    auto *index = &server->hit_index;
+
+    index->generation++;
+
+    node = entry_root_of(server, node);
+
+    if(!node){
+        return;
+    }
+
+    auto it = index->entries.find(node);
+
+    struct yawc_hit_entry *entry;
+
+    if(it == index->entries.end()){
+        entry = new yawc_hit_entry{};
+        entry->index = index;
+        entry->node = node;
+
+        entry->destroy.notify = handle_hit_entry_destroy;
+        wl_signal_add(&node->events.destroy, &entry->destroy);
+
+        index->entries[node] = entry;
+    } else{
+        entry = it->second;
+    }
+
+    if(!entry->dirty){
+        entry->dirty = true;
+        index->dirty.push_back(entry);
+    }
+}
+
+//a and b are both entry roots, so their parents are layer trees (or the same one)
+bool node_above(struct wlr_scene_node *a, struct wlr_scene_node *b){
+    if(a->parent != b->parent){
+        return node_above(&a->parent->node, &b->parent->node);
+    }
+
+    //later siblings are drawn on top
+    for(struct wl_list *link = a->link.next; link != &a->parent->children; link = link->next){
+        if(link == &b->link){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool node_skipped(struct wlr_scene_node *node, uint32_t mask){
+    //buffers keep wm_buffers in data, only trees and rects get descriptors
+    if(node->type == WLR_SCENE_NODE_BUFFER || !node->data){
+        return false;
+    }
+
+    auto *desc = static_cast<struct yawc_scene_descriptor*>(node->data);
+
+    return ((mask & YAWC_HIT_SKIP_DRAG_ICONS) && desc->type == YAWC_SCENE_DESC_DRAG_ICON)
+        || ((mask & YAWC_HIT_SKIP_NON_INTERACTIVE) && desc->type == YAWC_SCENE_DESC_NON_INTERACTIVE);
+}
+
+//wlr_scene_node_at that can skip subtrees, x and y are relative to the parent of node
+struct wlr_scene_node *node_at_masked(struct wlr_scene_node *node, double x, double y,
+        double *nx, double *ny, uint32_t mask){
+    if(!node->enabled || node_skipped(node, mask)){
+        return nullptr;
+    }
+
+    x -= node->x;
+    y -= node->y;
+
+    if(node->type == WLR_SCENE_NODE_TREE){
+        struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+
+        struct wlr_scene_node *child;
+        wl_list_for_each_reverse(child, &tree->children, link){
+            if(struct wlr_scene_node *hit = node_at_masked(child, x, y, nx, ny, mask)){
+                return hit;
+            }
+        }
+
+        return nullptr;
+    }
+
+    int width, height;
+    wlr_scene_node_get_size(node, &width, &height);
+
+    if(x < 0 || y < 0 || x >= width || y >= height){
+        return nullptr;
+    }
+
+    if(node->type == WLR_SCENE_NODE_BUFFER){
+        struct wlr_scene_buffer *buffer = wlr_scene_buffer_from_node(node);
+
+        if(buffer->point_accepts_input && !buffer->point_accepts_input(buffer, &x, &y)){
+            return nullptr;
+        }
+    }
+
+    *nx = x;
+    *ny = y;
+
+    return node;
+}
+
+struct wlr_scene_node *hit_index_node_at(struct yawc_server *server, double lx, double ly,
+        double *sx, double *sy, uint32_t mask){
+    auto *index = &server->hit_index;
+
+    double hx, hy;
+
+    if(server->drag.icons && server->drag.icons->node.enabled){
+        //always raised above every layer while a drag is going
+        if(auto *node = node_at_masked(&server->drag.icons->node, lx, ly, &hx, &hy, mask)){
+            if(sx){
+                *sx = hx;
+            }
+
+            if(sy){
+                *sy = hy;
+            }
+
+            return node;
+        }
+    }
+
+    for(auto *entry: index->dirty){
+        entry_refresh(entry);
+    }
+
+    index->dirty.clear();
+
+    int x = std::floor(lx), y = std::floor(ly);
+
+    struct wlr_scene_node *best = nullptr, *best_root = nullptr;
+    double best_sx = 0, best_sy = 0;
+
+    auto test = [&](struct yawc_hit_entry *entry){
+        if(x < entry->x1 || x >= entry->x2 || y < entry->y1 || y >= entry->y2){
+            return;
+        }
+
+        if((mask & YAWC_HIT_SKIP_OVERLAYS) && entry->node->type == WLR_SCENE_NODE_BUFFER
+                && entry->node->parent == server->layers.overlay){
+            return;
+        }
+
+        if(best_root && !node_above(entry->node, best_root)){
+            return;
+        }
+
+        //something above it is disabled
+        int px, py;
+        if(!wlr_scene_node_coords(&entry->node->parent->node, &px, &py)){
+            return;
+        }
+
+        struct wlr_scene_node *node = node_at_masked(entry->node, lx - px, ly - py, &hx, &hy, mask);
+
+        if(!node){
+            return;
+        }
+
+        best = node;
+        best_root = entry->node;
+        best_sx = hx;
+        best_sy = hy;
+    };
+
+    auto it = index->cells.find(cell_key(x >> yawc_hit_index::CELL_SHIFT, y >> yawc_hit_index::CELL_SHIFT));
+
+    if(it != index->cells.end()){
+        for(auto *entry: it->second){
+            test(entry);
+        }
+    }
+
+    for(auto *entry: index->oversized){
+        test(entry);
+    }
+
+    if(best){
+        if(sx){
+            *sx = best_sx;
+        }
+
+        if(sy){
+            *sy = best_sy;
+        }
+    }
+
+    return best;
+}
+
+void classify_hit(struct yawc_hit_result *hit){
+    struct wlr_scene_node *node = hit->node;
+
+    hit->grip_edges = WM_RESIZE_EDGE_INVALID;
+
+    if(node->type == WLR_SCENE_NODE_RECT){
+        if(auto *desc = scene_descriptor_try_get(node, YAWC_SCENE_DESC_RESIZE_GRIP)){
+            hit->toplevel = static_cast<struct yawc_toplevel*>(desc->parent);
+            hit->grip_edges = (uint32_t)(uintptr_t)desc->data;
+        }
+
+        return;
+    }
+
+    if(node->type != WLR_SCENE_NODE_BUFFER){
+        return;
+    }
+
+    struct wlr_scene_surface *scene_surface =
+        wlr_scene_surface_try_from_buffer(wlr_scene_buffer_from_node(node));
+
+    if(!scene_surface){
+        return;
+    }
+
+    hit->surface = scene_surface->surface;
+
+    struct wlr_scene_tree *tree = node->parent;
+    while(tree && !tree->node.data){
+        tree = tree->node.parent;
+    }
+
+    if(auto *desc = tree ? scene_descriptor_try_get(&tree->node, YAWC_SCENE_DESC_VIEW) : nullptr){
+        hit->toplevel = static_cast<struct yawc_toplevel*>(desc->parent);
+    }
+}
+
+const struct yawc_hit_result *hit_index_resolve(struct yawc_server *server, double lx, double ly,
+        uint32_t mask){
+    auto *index = &server->hit_index;
+
+    if(index->cached && index->cached_generation == index->generation
+            && index->cached_lx == lx && index->cached_ly == ly && index->cached_mask == mask){
+        return &index->cached_hit;
+    }
+
+    struct yawc_hit_result hit = {};
+    hit.node = hit_index_node_at(server, lx, ly, &hit.sx, &hit.sy, mask);
+
+    if(hit.node){
+        classify_hit(&hit);
+    }
+
+    //drag icons move with the cursor without telling the index
+    index->cached = (mask & YAWC_HIT_SKIP_DRAG_ICONS) || !server->drag.icons || !server->drag.icons->node.enabled;
+    index->cached_lx = lx;
+    index->cached_ly = ly;
+    index->cached_mask = mask;
+    index->cached_generation = index->generation;
+    index->cached_hit = hit;
+
+    return &index->cached_hit;
+}
+
+void handle_hit_surface_commit(struct wl_listener *listener, void *data){
+    struct yawc_hit_surface *tracked = wl_container_of(listener, tracked, commit);
+
+    if(struct wlr_scene_node *node = surface_scene_node(tracked->surface)){
+        hit_index_update(tracked->server, node);
+    } else{
+        tracked->server->hit_index.generation++;
+    }
+}
+
+void handle_hit_surface_destroy(struct wl_listener *listener, void *data){
+    struct yawc_hit_surface *tracked = wl_container_of(listener, tracked, destroy);
+
+    //its scene buffer goes away with it
+    tracked->server->hit_index.generation++;
+
+    wl_list_remove(&tracked->commit.link);
+    wl_list_remove(&tracked->destroy.link);
+
+    delete tracked;
+}
+
+void handle_hit_new_surface(struct wl_listener *listener, void *data){
+    struct yawc_hit_index *index = wl_container_of(listener, index, new_surface);
+    struct yawc_server *server = wl_container_of(index, server, hit_index);
+    struct wlr_surface *surface = static_cast<struct wlr_surface*>(data);
+
+    auto *tracked = new yawc_hit_surface{};
+    tracked->server = server;
+    tracked->surface = surface;
+
+    //any commit (subsurfaces and popups included) can change the size of the tree it's in
+    tracked->commit.notify = handle_hit_surface_commit;
+    wl_signal_add(&surface->events.commit, &tracked->commit);
+
+    tracked->destroy.notify = handle_hit_surface_destroy;
+    wl_signal_add(&surface->events.destroy, &tracked->destroy);
+}
+
+void hit_index_init(struct yawc_server *server){
+    server->hit_index.new_surface.notify = handle_hit_new_surface;
+    wl_signal_add(&server->compositor->events.new_surface, &server->hit_index.new_surface);
+}
+
+void hit_index_finish(struct yawc_server *server){
+    if(server->hit_index.new_surface.notify){
+        wl_list_remove(&server->hit_index.new_surface.link);
+        server->hit_index.new_surface.notify = nullptr;
+    }
+}
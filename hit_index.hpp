@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <wayland-server-core.h>
+
+struct yawc_server;
+struct yawc_toplevel;
+struct wlr_scene_node;
+struct wlr_scene_tree;
+struct wlr_surface;
+
+enum yawc_hit_mask : uint32_t {
+    YAWC_HIT_SKIP_NONE = 0,
+    YAWC_HIT_SKIP_DRAG_ICONS = 1 << 0, // trees tagged YAWC_SCENE_DESC_DRAG_ICON
+    YAWC_HIT_SKIP_NON_INTERACTIVE = 1 << 1, // trees and rects tagged YAWC_SCENE_DESC_NON_INTERACTIVE
+    YAWC_HIT_SKIP_OVERLAYS = 1 << 2, // wm overlays
+};
+
+constexpr uint32_t YAWC_HIT_DEFAULT_MASK = YAWC_HIT_SKIP_DRAG_ICONS | YAWC_HIT_SKIP_NON_INTERACTIVE;
+
+//what's under a point, resolved once per point and shared by the compositor and the wm
+struct yawc_hit_result {
+    struct wlr_scene_node *node;
+    double sx, sy;
+
+    struct wlr_surface *surface; // when node is a client surface
+    struct yawc_toplevel *toplevel; // view owning surface, or the one owning the grip
+
+    uint32_t grip_edges; // WM_RESIZE_EDGE_INVALID unless node is a resize grip
+};
+
+//one per direct child of a layer tree (toplevels, layer surfaces, lock surfaces, overlays)
+struct yawc_hit_entry {
+    struct yawc_hit_index *index;
+    struct wlr_scene_node *node;
+
+    //layout coords, covers every buffer and rect below node (disabled ones too)
+    int x1, y1, x2, y2;
+    bool placed;
+    bool dirty;
+
+    struct wl_listener destroy;
+};
+
+//uniform grid over the layout, cells hold the entries whose box touches them.
+//boxes are refreshed lazily, stacking and enabled state are read from the scene on every query
+struct yawc_hit_index {
+    static constexpr int CELL_SHIFT = 8; // 256px cells
+    static constexpr int MAX_CELLS = 4096; // bigger entries go to the oversized list
+
+    std::unordered_map<uint64_t, std::vector<struct yawc_hit_entry*>> cells;
+    std::vector<struct yawc_hit_entry*> oversized;
+
+    std::unordered_map<struct wlr_scene_node*, struct yawc_hit_entry*> entries;
+    std::vector<struct yawc_hit_entry*> dirty;
+
+    //bumped by anything that can change (or free) what's under a point
+    uint64_t generation = 0;
+
+    bool cached = false;
+    double cached_lx, cached_ly;
+    uint32_t cached_mask;
+    uint64_t cached_generation;
+    struct yawc_hit_result cached_hit;
+
+    struct wl_listener new_surface = {};
+};
+
+void hit_index_init(struct yawc_server *server);
+void hit_index_finish(struct yawc_server *server);
+
+//call after anything below a layer tree moved, resized or got created.
+//the entry owning node is refreshed before the next query
+void hit_index_update(struct yawc_server *server, struct wlr_scene_node *node);
+
+//same contract as wlr_scene_node_at on the whole scene, minus whatever mask skips
+struct wlr_scene_node *hit_index_node_at(struct yawc_server *server, double lx, double ly,
+        double *sx, double *sy, uint32_t mask = YAWC_HIT_DEFAULT_MASK);
+
+//stays valid until the next scene change
+const struct yawc_hit_result *hit_index_resolve(struct yawc_server *server, double lx, double ly,
+        uint32_t mask = YAWC_HIT_DEFAULT_MASK);
@@ -0,0 +1,618 @@
+#include "server.hpp"
+
+#include "input_trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <wlr/interfaces/wlr_keyboard.h>
+#include <wlr/interfaces/wlr_pointer.h>
+
+constexpr size_t TRACE_CHUNK = 64 * 1024;
+constexpr int TRACE_FLUSH_MS = 1000;
+constexpr size_t REPLAY_FAST_CHUNK = 4096; // records per loop iteration, frames still get a turn
+
+constexpr uint8_t TRACE_KIND_KEYBOARD = 0;
+constexpr uint8_t TRACE_KIND_POINTER = 1;
+
+struct yawc_trace_device {
+    struct yawc_server *server;
+    struct wlr_input_device *device;
+    uint8_t index;
+
+    //replayed devices are ours
+    struct wlr_keyboard *keyboard;
+    struct wlr_pointer *pointer;
+
+    struct wl_listener key;
+    struct wl_listener motion;
+    struct wl_listener motion_absolute;
+    struct wl_listener button;
+    struct wl_listener axis;
+    struct wl_listener frame;
+    struct wl_listener destroy;
+};
+
+const struct wlr_keyboard_impl replay_keyboard_impl = {
+    .name = "yawc-replay-keyboard",
+};
+
+const struct wlr_pointer_impl replay_pointer_impl = {
+    .name = "yawc-replay-pointer",
+};
+
+template<typename T>
+void trace_put(std::vector<uint8_t> &buffer, T value){
+    auto *bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+bool trace_get(struct yawc_input_trace *trace, T &out){
+    if(trace->offset + sizeof(T) > trace->data.size()){
+        return false;
+    }
+
+    std::memcpy(&out, trace->data.data() + trace->offset, sizeof(T));
+    trace->offset += sizeof(T);
+
+    return true;
+}
+
+void trace_flush(struct yawc_input_trace *trace, bool force){
+    if(!trace->record || trace->buffer.empty() || (!force && trace->buffer.size() < TRACE_CHUNK)){
+        return;
+    }
+
+    if(fwrite(trace->buffer.data(), 1, trace->buffer.size(), trace->record) != trace->buffer.size()){
+        wlr_log(WLR_ERROR, "Failed to write the input trace, stopping the recording");
+
+        fclose(trace->record);
+        trace->record = nullptr;
+    }
+
+    trace->buffer.clear();
+}
+
+int handle_trace_flush_timer(void *data){
+    auto *trace = static_cast<struct yawc_input_trace*>(data);
+
+    trace_flush(trace, true);
+
+    if(trace->record){
+        fflush(trace->record);
+        wl_event_source_timer_update(trace->flush_timer, TRACE_FLUSH_MS);
+    }
+
+    return 0;
+}
+
+void trace_begin(struct yawc_input_trace *trace, enum yawc_trace_record type, uint8_t index){
+    int64_t delta_us = std::clamp<int64_t>((utils::now_ns() - trace->last_ns) / 1000, 0, UINT32_MAX);
+
+    //advance by what was written so rounding doesn't drift
+    trace->last_ns += delta_us * 1000;
+
+    trace_put<uint8_t>(trace->buffer, type);
+    trace_put<uint32_t>(trace->buffer, delta_us);
+    trace_put<uint8_t>(trace->buffer, index);
+}
+
+void trace_end(struct yawc_input_trace *trace){
+    trace_flush(trace, false);
+}
+
+bool input_trace_record_start(struct yawc_server *server){
+    auto *trace = &server->trace;
+
+    trace->record = fopen(trace->record_path.c_str(), "wb");
+
+    if(!trace->record){
+        wlr_log(WLR_ERROR, "Failed to open %s for the input trace", trace->record_path.c_str());
+        return false;
+    }
+
+    trace->buffer.insert(trace->buffer.end(), {'Y', 'W', 'I', 'T', YAWC_TRACE_VERSION});
+    trace->last_ns = utils::now_ns();
+
+    trace->flush_timer = wl_event_loop_add_timer(server->wl_event_loop, handle_trace_flush_timer, trace);
+
+    if(trace->flush_timer){
+        wl_event_source_timer_update(trace->flush_timer, TRACE_FLUSH_MS);
+    }
+
+    wlr_log(WLR_INFO, "Recording input to %s", trace->record_path.c_str());
+
+    return true;
+}
+
+void trace_device_detach(struct yawc_trace_device *trace_device){
+    if(trace_device->device->type == WLR_INPUT_DEVICE_KEYBOARD){
+        wl_list_remove(&trace_device->key.link);
+    } else{
+        wl_list_remove(&trace_device->motion.link);
+        wl_list_remove(&trace_device->motion_absolute.link);
+        wl_list_remove(&trace_device->button.link);
+        wl_list_remove(&trace_device->axis.link);
+        wl_list_remove(&trace_device->frame.link);
+    }
+
+    wl_list_remove(&trace_device->destroy.link);
+}
+
+void input_trace_record_device(struct yawc_server *server, struct wlr_input_device *device){
+    auto *trace = &server->trace;
+
+    if(!trace->record){
+        return;
+    }
+
+    if(device->type != WLR_INPUT_DEVICE_KEYBOARD && device->type != WLR_INPUT_DEVICE_POINTER){
+        return;
+    }
+
+    if(trace->next_index == UINT8_MAX){
+        wlr_log(WLR_ERROR, "Too many input devices in the trace, not recording %s", device->name);
+        return;
+    }
+
+    auto *trace_device = new yawc_trace_device{};
+    trace_device->server = server;
+    trace_device->device = device;
+    trace_device->index = trace->next_index++;
+
+    const char *name = device->name ? device->name : "";
+    uint16_t length = std::min<size_t>(strlen(name), UINT16_MAX);
+
+    trace_begin(trace, YAWC_TRACE_DEVICE_ADD, trace_device->index);
+    trace_put<uint8_t>(trace->buffer, device->type == WLR_INPUT_DEVICE_KEYBOARD ? TRACE_KIND_KEYBOARD : TRACE_KIND_POINTER);
+    trace_put<uint16_t>(trace->buffer, length);
+    trace->buffer.insert(trace->buffer.end(), name, name + length);
+    trace_end(trace);
+
+    if(device->type == WLR_INPUT_DEVICE_KEYBOARD){
+        trace_device->key.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, key);
+            auto *event = static_cast<struct wlr_keyboard_key_event*>(data);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_KEY, trace_device->index);
+            trace_put<uint32_t>(trace->buffer, event->keycode);
+            trace_put<uint8_t>(trace->buffer, event->state);
+            trace_end(trace);
+        };
+        wl_signal_add(&wlr_keyboard_from_input_device(device)->events.key, &trace_device->key);
+    } else{
+        auto *pointer = wlr_pointer_from_input_device(device);
+
+        trace_device->motion.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, motion);
+            auto *event = static_cast<struct wlr_pointer_motion_event*>(data);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_MOTION, trace_device->index);
+            trace_put<double>(trace->buffer, event->delta_x);
+            trace_put<double>(trace->buffer, event->delta_y);
+            trace_put<double>(trace->buffer, event->unaccel_dx);
+            trace_put<double>(trace->buffer, event->unaccel_dy);
+            trace_end(trace);
+        };
+        wl_signal_add(&pointer->events.motion, &trace_device->motion);
+
+        trace_device->motion_absolute.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, motion_absolute);
+            auto *event = static_cast<struct wlr_pointer_motion_absolute_event*>(data);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_MOTION_ABSOLUTE, trace_device->index);
+            trace_put<double>(trace->buffer, event->x);
+            trace_put<double>(trace->buffer, event->y);
+            trace_end(trace);
+        };
+        wl_signal_add(&pointer->events.motion_absolute, &trace_device->motion_absolute);
+
+        trace_device->button.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, button);
+            auto *event = static_cast<struct wlr_pointer_button_event*>(data);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_BUTTON, trace_device->index);
+            trace_put<uint32_t>(trace->buffer, event->button);
+            trace_put<uint8_t>(trace->buffer, event->state);
+            trace_end(trace);
+        };
+        wl_signal_add(&pointer->events.button, &trace_device->button);
+
+        trace_device->axis.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, axis);
+            auto *event = static_cast<struct wlr_pointer_axis_event*>(data);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_AXIS, trace_device->index);
+            trace_put<uint8_t>(trace->buffer, event->source);
+            trace_put<uint8_t>(trace->buffer, event->orientation);
+            trace_put<int8_t>(trace->buffer, event->relative_direction);
+            trace_put<double>(trace->buffer, event->delta);
+            trace_put<int32_t>(trace->buffer, event->delta_discrete);
+            trace_end(trace);
+        };
+        wl_signal_add(&pointer->events.axis, &trace_device->axis);
+
+        trace_device->frame.notify = +[](struct wl_listener *listener, void *data){
+            struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, frame);
+            auto *trace = &trace_device->server->trace;
+
+            trace_begin(trace, YAWC_TRACE_FRAME, trace_device->index);
+            trace_end(trace);
+        };
+        wl_signal_add(&pointer->events.frame, &trace_device->frame);
+    }
+
+    trace_device->destroy.notify = +[](struct wl_listener *listener, void *data){
+        struct yawc_trace_device *trace_device = wl_container_of(listener, trace_device, destroy);
+        auto *trace = &trace_device->server->trace;
+
+        trace_begin(trace, YAWC_TRACE_DEVICE_REMOVE, trace_device->index);
+        trace_end(trace);
+
+        trace_device_detach(trace_device);
+        std::erase(trace->recorded, trace_device);
+
+        delete trace_device;
+    };
+    wl_signal_add(&device->events.destroy, &trace_device->destroy);
+
+    trace->recorded.push_back(trace_device);
+}
+
+void replay_destroy_device(struct yawc_trace_device *trace_device){
+    //finishing emits destroy, the seat lets go of it like of any unplugged device
+    if(trace_device->keyboard){
+        wlr_keyboard_finish(trace_device->keyboard);
+        delete trace_device->keyboard;
+    } else{
+        wlr_pointer_finish(trace_device->pointer);
+        delete trace_device->pointer;
+    }
+
+    delete trace_device;
+}
+
+struct yawc_trace_device *replay_device(struct yawc_input_trace *trace, uint8_t index, bool keyboard){
+    if(index >= trace->replayed_devices.size()){
+        return nullptr;
+    }
+
+    auto *trace_device = trace->replayed_devices[index];
+
+    if(!trace_device || (trace_device->keyboard != nullptr) != keyboard){
+        return nullptr;
+    }
+
+    return trace_device;
+}
+
+//one record, false if the trace is cut short
+bool replay_record(struct yawc_server *server){
+    auto *trace = &server->trace;
+
+    uint8_t type, index;
+    uint32_t delta_us;
+
+    if(!trace_get(trace, type) || !trace_get(trace, delta_us) || !trace_get(trace, index)){
+        return false;
+    }
+
+    uint32_t time_msec = trace->due_ns / 1000000;
+
+    switch(type){
+        case YAWC_TRACE_DEVICE_ADD: {
+            uint8_t kind;
+            uint16_t length;
+
+            if(!trace_get(trace, kind) || !trace_get(trace, length) || trace->offset + length > trace->data.size()){
+                return false;
+            }
+
+            std::string name(reinterpret_cast<const char*>(trace->data.data() + trace->offset), length);
+            trace->offset += length;
+
+            if(index >= trace->replayed_devices.size()){
+                trace->replayed_devices.resize(index + 1, nullptr);
+            }
+
+            if(trace->replayed_devices[index]){
+                replay_destroy_device(trace->replayed_devices[index]);
+            }
+
+            auto *trace_device = new yawc_trace_device{};
+            trace_device->server = server;
+            trace_device->index = index;
+
+            //same name as the recorded device so the same input config applies
+            if(kind == TRACE_KIND_KEYBOARD){
+                trace_device->keyboard = new wlr_keyboard{};
+                wlr_keyboard_init(trace_device->keyboard, &replay_keyboard_impl, name.c_str());
+                trace_device->device = &trace_device->keyboard->base;
+            } else{
+                trace_device->pointer = new wlr_pointer{};
+                wlr_pointer_init(trace_device->pointer, &replay_pointer_impl, name.c_str());
+                trace_device->device = &trace_device->pointer->base;
+            }
+
+            trace->replayed_devices[index] = trace_device;
+
+            wl_signal_emit_mutable(&server->backend->events.new_input, trace_device->device);
+
+            return true;
+        }
+        case YAWC_TRACE_DEVICE_REMOVE: {
+            if(index < trace->replayed_devices.size() && trace->replayed_devices[index]){
+                replay_destroy_device(trace->replayed_devices[index]);
+                trace->replayed_devices[index] = nullptr;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_KEY: {
+            uint32_t keycode;
+            uint8_t state;
+
+            if(!trace_get(trace, keycode) || !trace_get(trace, state)){
+                return false;
+            }
+
+            if(auto *trace_device = replay_device(trace, index, true)){
+                struct wlr_keyboard_key_event event = {
+                    .time_msec = time_msec,
+                    .keycode = keycode,
+                    .update_state = true,
+                    .state = (enum wl_keyboard_key_state)state,
+                };
+
+                wlr_keyboard_notify_key(trace_device->keyboard, &event);
+                trace->replayed++;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_MOTION: {
+            double dx, dy, unaccel_dx, unaccel_dy;
+
+            if(!trace_get(trace, dx) || !trace_get(trace, dy) || !trace_get(trace, unaccel_dx) || !trace_get(trace, unaccel_dy)){
+                return false;
+            }
+
+            if(auto *trace_device = replay_device(trace, index, false)){
+                struct wlr_pointer_motion_event event = {
+                    .pointer = trace_device->pointer,
+                    .time_msec = time_msec,
+                    .delta_x = dx,
+                    .delta_y = dy,
+                    .unaccel_dx = unaccel_dx,
+                    .unaccel_dy = unaccel_dy,
+                };
+
+                wl_signal_emit_mutable(&trace_device->pointer->events.motion, &event);
+                trace->replayed++;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_MOTION_ABSOLUTE: {
+            double x, y;
+
+            if(!trace_get(trace, x) || !trace_get(trace, y)){
+                return false;
+            }
+
+            if(auto *trace_device = replay_device(trace, index, false)){
+                struct wlr_pointer_motion_absolute_event event = {
+                    .pointer = trace_device->pointer,
+                    .time_msec = time_msec,
+                    .x = x,
+                    .y = y,
+                };
+
+                wl_signal_emit_mutable(&trace_device->pointer->events.motion_absolute, &event);
+                trace->replayed++;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_BUTTON: {
+            uint32_t button;
+            uint8_t state;
+
+            if(!trace_get(trace, button) || !trace_get(trace, state)){
+                return false;
+            }
+
+            if(auto *trace_device = replay_device(trace, index, false)){
+                struct wlr_pointer_button_event event = {
+                    .pointer = trace_device->pointer,
+                    .time_msec = time_msec,
+                    .button = button,
+                    .state = (enum wl_pointer_button_state)state,
+                };
+
+                wl_signal_emit_mutable(&trace_device->pointer->events.button, &event);
+                trace->replayed++;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_AXIS: {
+            uint8_t source, orientation;
+            int8_t relative_direction;
+            double delta;
+            int32_t delta_discrete;
+
+            if(!trace_get(trace, source) || !trace_get(trace, orientation) || !trace_get(trace, relative_direction)
+                    || !trace_get(trace, delta) || !trace_get(trace, delta_discrete)){
+                return false;
+            }
+
+            if(auto *trace_device = replay_device(trace, index, false)){
+                struct wlr_pointer_axis_event event = {
+                    .pointer = trace_device->pointer,
+                    .time_msec = time_msec,
+                    .source = (enum wl_pointer_axis_source)source,
+                    .orientation = (enum wl_pointer_axis)orientation,
+                    .relative_direction = (enum wl_pointer_axis_relative_direction)relative_direction,
+                    .delta = delta,
+                    .delta_discrete = delta_discrete,
+                };
+
+                wl_signal_emit_mutable(&trace_device->pointer->events.axis, &event);
+                trace->replayed++;
+            }
+
+            return true;
+        }
+        case YAWC_TRACE_FRAME: {
+            if(auto *trace_device = replay_device(trace, index, false)){
+                wl_signal_emit_mutable(&trace_device->pointer->events.frame, trace_device->pointer);
+            }
+
+            return true;
+        }
+    }
+
+    wlr_log(WLR_ERROR, "Unknown record %u in the input trace", type);
+
+    return false;
+}
+
+void replay_done(struct yawc_server *server){
+    auto *trace = &server->trace;
+
+    double elapsed_ms = (utils::now_ns() - trace->start_ns) / 1e6;
+
+    wlr_log(WLR_INFO, "Replayed %lu input events in %.1fms (%.0f events/s)", 
+        trace->replayed, elapsed_ms, elapsed_ms > 0 ? trace->replayed / (elapsed_ms / 1000) : 0);
+
+    //timings of the run, input latency included
+    if(!frame_stats_dump(server, server->frame_stats_path)){
+        wlr_log(WLR_ERROR, "Failed to write the frame stats to %s", server->frame_stats_path.c_str());
+    }
+
+    wl_display_terminate(server->wl_display);
+}
+
+int replay_tick(void *data){
+    auto *server = static_cast<struct yawc_server*>(data);
+    auto *trace = &server->trace;
+
+    int64_t now = utils::now_ns();
+    size_t budget = REPLAY_FAST_CHUNK;
+
+    while(trace->offset < trace->data.size()){
+        uint32_t delta_us;
+
+        if(trace->offset + sizeof(uint8_t) + sizeof(delta_us) > trace->data.size()){
+            break;
+        }
+
+        std::memcpy(&delta_us, trace->data.data() + trace->offset + sizeof(uint8_t), sizeof(delta_us));
+
+        int64_t due = trace->due_ns + (int64_t)delta_us * 1000;
+
+        if(trace->replay_fast){
+            if(!budget--){
+                wl_event_source_timer_update(trace->timer, 1);
+                return 0;
+            }
+        } else if(due > now){
+            wl_event_source_timer_update(trace->timer, std::max<int64_t>((due - now + 999999) / 1000000, 1));
+            return 0;
+        }
+
+        trace->due_ns = trace->replay_fast ? now : due;
+
+        if(!replay_record(server)){
+            wlr_log(WLR_ERROR, "The input trace is cut short");
+            break;
+        }
+    }
+
+    replay_done(server);
+
+    return 0;
+}
+
+bool input_trace_replay_start(struct yawc_server *server){
+    auto *trace = &server->trace;
+
+    std::ifstream file(trace->replay_path, std::ios::binary);
+
+    if(!file){
+        wlr_log(WLR_ERROR, "Failed to open the input trace %s", trace->replay_path.c_str());
+        return false;
+    }
+
+    trace->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if(trace->data.size() < 5 || std::memcmp(trace->data.data(), "YWIT", 4) || trace->data[4] != YAWC_TRACE_VERSION){
+        wlr_log(WLR_ERROR, "%s isn't an input trace yawc can replay", trace->replay_path.c_str());
+        trace->data.clear();
+        return false;
+    }
+
+    trace->offset = 5;
+    trace->start_ns = trace->due_ns = utils::now_ns();
+
+    trace->timer = wl_event_loop_add_timer(server->wl_event_loop, replay_tick, server);
+
+    if(!trace->timer){
+        return false;
+    }
+
+    wl_event_source_timer_update(trace->timer, 1);
+
+    wlr_log(WLR_INFO, "Replaying input from %s%s", trace->replay_path.c_str(), trace->replay_fast ? " as fast as possible" : "");
+
+    return true;
+}
+
+void input_trace_finish(struct yawc_server *server){
+    auto *trace = &server->trace;
+
+    if(trace->timer){
+        wl_event_source_remove(trace->timer);
+        trace->timer = nullptr;
+    }
+
+    if(trace->flush_timer){
+        wl_event_source_remove(trace->flush_timer);
+        trace->flush_timer = nullptr;
+    }
+
+    for(auto *trace_device: trace->replayed_devices){
+        if(trace_device){
+            replay_destroy_device(trace_device);
+        }
+    }
+
+    trace->replayed_devices.clear();
+
+    for(auto *trace_device: trace->recorded){
+        trace_device_detach(trace_device);
+        delete trace_device;
+    }
+
+    trace->recorded.clear();
+
+    if(trace->record){
+        trace_flush(trace, true);
+
+        if(trace->record){
+            fclose(trace->record);
+            trace->record = nullptr;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct yawc_server;
+struct wlr_input_device;
+struct wl_event_source;
+
+//trace file: "YWIT", a version byte, then records of
+//type (u8), time since the previous record in us (u32), device index (u8) and the payload
+enum yawc_trace_record : uint8_t {
+    YAWC_TRACE_DEVICE_ADD, // kind (u8), name length (u16), name
+    YAWC_TRACE_DEVICE_REMOVE,
+    YAWC_TRACE_KEY, // keycode (u32), state (u8)
+    YAWC_TRACE_MOTION, // dx, dy, unaccel dx, unaccel dy (f64)
+    YAWC_TRACE_MOTION_ABSOLUTE, // x, y (f64)
+    YAWC_TRACE_BUTTON, // button (u32), state (u8)
+    YAWC_TRACE_AXIS, // source, orientation (u8), relative direction (i8), delta (f64), discrete (i32)
+    YAWC_TRACE_FRAME,
+};
+
+constexpr uint8_t YAWC_TRACE_VERSION = 1;
+
+struct yawc_trace_device;
+
+struct yawc_input_trace {
+    //recording
+    std::string record_path;
+    FILE *record = nullptr;
+    std::vector<uint8_t> buffer; // written out in chunks
+    int64_t last_ns = 0;
+    uint8_t next_index = 0;
+    std::vector<struct yawc_trace_device*> recorded;
+    struct wl_event_source *flush_timer = nullptr; // bounds what a crash can lose
+
+    //replay
+    std::string replay_path;
+    bool replay_fast = false; // ignore the recorded timing
+    std::vector<uint8_t> data;
+    size_t offset = 0;
+    int64_t due_ns = 0; // when the last record was due
+    int64_t start_ns = 0;
+    uint64_t replayed = 0;
+    std::vector<struct yawc_trace_device*> replayed_devices; // by recorded index
+    struct wl_event_source *timer = nullptr;
+};
+
+bool input_trace_record_start(struct yawc_server *server);
+void input_trace_record_device(struct yawc_server *server, struct wlr_input_device *device);
+
+//feeds the trace through virtual devices, the compositor exits once it's done
+bool input_trace_replay_start(struct yawc_server *server);
+
+void input_trace_finish(struct yawc_server *server);
@@ -1,8 +1,8 @@
-#include <ctime>
 #include <ranges>
 #include <string>
 
 #include "server.hpp"
+#include "actions.hpp"
 #include "utils.hpp"
 
 yawc_keybind_manager::yawc_keybind_manager(struct yawc_server *server){
@@ -11,84 +11,101 @@ yawc_keybind_manager::yawc_keybind_manager(struct yawc_server *server){
     this->global_shortcut_path = "/tmp/yawc_global_shortcuts.log";
     remove(this->global_shortcut_path.c_str());
 
+    this->sequence_timer = wl_event_loop_add_timer(server->wl_event_loop, +[](void *data){
+        auto *manager = static_cast<yawc_keybind_manager*>(data);
+
+        wlr_log(WLR_DEBUG, "Keybind sequence timed out");
+        manager->cur_state = 0;
+
+        return 0;
+    }, this);
+
     this->reload();
 }
 
+yawc_keybind_manager::~yawc_keybind_manager(){
+    if(this->sequence_timer){
+        wl_event_source_remove(this->sequence_timer);
+    }
+}
+
 void yawc_keybind_manager::reload(){
-    this->cur_node = this->server->config->keybind_tree.get();
+    this->set_state(0);
 
     this->cur_global_shortcut = nullptr;
-    this->cur_pressed_button = 0; 
-    this->last_time = time(nullptr);
+    this->cur_pressed_key = 0; 
 }
 
 bool yawc_keybind_manager::in_sequence(){
-    return this->cur_node != this->server->config->keybind_tree.get();
+    return this->cur_state != 0;
 }
 
-void yawc_keybind_manager::store(uint32_t button, uint32_t modifiers, bool pressed){
-    if(!pressed){
-        this->pressed_keys.erase(button);
+void yawc_keybind_manager::set_state(uint32_t state){
+    this->cur_state = state;
 
-        if(this->cur_global_shortcut && this->cur_pressed_button == button){
+    if(this->sequence_timer){
+        wl_event_source_timer_update(this->sequence_timer, state ? YAWC_KEYBIND_SEQUENCE_TIMEOUT_MS : 0);
+    }
+}
+
+void yawc_keybind_manager::store(uint32_t keycode, uint32_t sym, uint32_t modifiers, bool pressed){
+    if(keycode < YAWC_KEYCODE_COUNT){
+        this->pressed_keys[keycode] = pressed;
+    }
+
+    if(!pressed){
+        if(this->cur_global_shortcut && this->cur_pressed_key == keycode){
             wlr_hyprland_global_shortcut_v1_send_released(this->cur_global_shortcut->shortcut, 0, 0, 0);
             this->cur_global_shortcut = nullptr;
-            this->cur_pressed_button = 0;
+            this->cur_pressed_key = 0;
         }
 
         return;
     }
 
-    this->pressed_keys.insert(button);
+    auto &table = this->server->config->keybinds;
 
-    uint64_t id = ((uint64_t)modifiers << 32) + button;
+    uint64_t id = ((uint64_t)modifiers << 32) + sym;
 
-    time_t now = time(nullptr);
-    
-    if(now - this->last_time > 1 && this->in_sequence()){ // > 1 second timeout
-        this->cur_node = this->server->config->keybind_tree.get();
-    }
+    uint32_t next = table.step(this->cur_state, id);
 
-    if(this->cur_node->children.contains(id)){
-        this->cur_node = this->cur_node->children.at(id).get();
-        this->last_time = time(nullptr);
-        return;
-    } 
-
-    this->cur_node = this->server->config->keybind_tree.get(); //reset and recheck
-
-    if(this->cur_node->children.contains(id)){
-        this->cur_node = this->cur_node->children.at(id).get();
-        this->last_time = time(nullptr);
+    if(!next && this->in_sequence()){
+        next = table.step(0, id); //reset and recheck
     }
+
+    this->set_state(next);
 }
 
 struct yawc_bind_node *yawc_keybind_manager::triggered(){
-    time_t now = time(nullptr);
-
-    if(now - this->last_time > 1 && this->in_sequence()){
-        this->cur_node = this->server->config->keybind_tree.get();
-        return nullptr;
-    }
-
-    auto *node = this->cur_node;
+    auto *node = &this->server->config->keybinds.states[this->cur_state];
     
-    if(node->action.empty() || !node->children.empty()){
+    if(node->action.empty() || node->has_children){
         return nullptr;
     }
 
-    this->cur_node = this->server->config->keybind_tree.get();
+    this->set_state(0);
 
     return node;
 }
 
 bool yawc_keybind_manager::needed(){
-    return this->cur_node;
+    auto &states = this->server->config->keybinds.states;
+
+    return !states.empty() && states[0].has_children;
 }
 
 void yawc_keybind_manager::execute_action(struct yawc_bind_node *node, uint32_t trigger){
     auto *server = this->server;
 
+    if(node->builtin){
+        wlr_log(WLR_DEBUG, "Running action: %s", node->action.c_str());
+
+        //may reload the config, node is gone after this
+        run_builtin_action(server, node->builtin, node->builtin_arg);
+
+        return;
+    }
+
     if(!node->is_global_shortcut){
         wlr_log(WLR_DEBUG, "Executing command: %s", node->action.c_str());
 
@@ -117,7 +134,7 @@ void yawc_keybind_manager::execute_action(struct yawc_bind_node *node, uint32_t
     wl_list_for_each(gshorcut, &server->shortcuts, link){
         if(app_id == gshorcut->shortcut->app_id && id == gshorcut->shortcut->id){
             this->cur_global_shortcut = gshorcut;
-            this->cur_pressed_button = trigger;
+            this->cur_pressed_key = trigger;
 
             wlr_hyprland_global_shortcut_v1_send_pressed(gshorcut->shortcut, 0, 0, 0);
             
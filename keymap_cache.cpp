@@ -0,0 +1,190 @@
+#include "server.hpp"
+
+#include <memory>
+#include <optional>
+#include <xkbcommon/xkbcommon.h>
+
+struct yawc_keymap_names {
+    std::optional<std::string> layout, model, options, rules, variant;
+
+    std::string key() const{
+        std::string out;
+
+        //unset and empty are different to xkb, unset falls back to the environment
+        for(auto *part: {&layout, &model, &options, &rules, &variant}){
+            out += part->has_value() ? "=" + **part : "-";
+            out += '\x1f';
+        }
+
+        return out;
+    }
+
+    struct xkb_keymap *compile() const{
+        struct xkb_rule_names names;
+
+        names.layout = layout ? layout->c_str() : nullptr;
+        names.model = model ? model->c_str() : nullptr;
+        names.options = options ? options->c_str() : nullptr;
+        names.rules = rules ? rules->c_str() : nullptr;
+        names.variant = variant ? variant->c_str() : nullptr;
+
+        //a context per compile, they aren't safe to share between threads
+        struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+
+        if(!context){
+            return nullptr;
+        }
+
+        struct xkb_keymap *keymap = xkb_keymap_new_from_names(context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+
+        xkb_context_unref(context);
+
+        return keymap;
+    }
+};
+
+void keymap_set(struct yawc_keyboard *keyboard, struct xkb_keymap *keymap){
+    //same keymap, nothing to resend to the clients
+    if(keyboard->wlr_keyboard->keymap == keymap){
+        return;
+    }
+
+    wlr_keyboard_set_keymap(keyboard->wlr_keyboard, keymap);
+}
+
+//plain xkb defaults, what a keyboard gets when its own keymap doesn't compile
+struct xkb_keymap *keymap_cache_fallback(struct yawc_server *server, std::string &key){
+    auto &keymaps = server->keymaps.keymaps;
+
+    yawc_keymap_names names{};
+    key = names.key();
+
+    auto &keymap = keymaps[key];
+
+    if(!keymap){
+        keymap = names.compile();
+    }
+
+    if(!keymap){
+        wlr_log(WLR_ERROR, "Failed to compile the default keymap");
+        keymaps.erase(key);
+        return nullptr;
+    }
+
+    return keymap;
+}
+
+void keymap_cache_apply(struct yawc_server *server, struct yawc_keyboard *keyboard, const struct yawc_keyboard_config &config){
+    auto &keymaps = server->keymaps.keymaps;
+
+    yawc_keymap_names names{config.xkb_layout, config.xkb_model, config.xkb_options, config.xkb_rules, config.xkb_variant};
+
+    keyboard->keymap_key = names.key();
+
+    auto it = keymaps.find(keyboard->keymap_key);
+
+    if(it != keymaps.end() && it->second){
+        keymap_set(keyboard, it->second);
+        return;
+    }
+
+    //a keyboard without any keymap can't handle a key and another layout would type the wrong ones,
+    //so a new keyboard compiles inline. the worker result (if one is running) is dropped
+    if(!keyboard->wlr_keyboard->keymap){
+        struct xkb_keymap *keymap = names.compile();
+
+        if(keymap){
+            keymaps[keyboard->keymap_key] = keymap;
+        } else{
+            wlr_log(WLR_ERROR, "Failed to compile the keymap for %s, using the default one", keyboard->wlr_keyboard->base.name);
+            keymap = keymap_cache_fallback(server, keyboard->keymap_key);
+        }
+
+        if(keymap){
+            keymap_set(keyboard, keymap);
+        }
+
+        return;
+    }
+
+    //still compiling, the keyboard gets it along with the others waiting
+    if(it != keymaps.end()){
+        return;
+    }
+
+    //reloads keep the old keymap until the new one is ready
+    std::string key = keyboard->keymap_key;
+    keymaps[key] = nullptr;
+
+    auto result = std::make_shared<struct xkb_keymap*>(nullptr);
+
+    worker_pool_submit(&server->workers, [names, result]{
+        *result = names.compile();
+    }, [server, key, result]{
+        auto &keymaps = server->keymaps.keymaps;
+        auto it = keymaps.find(key);
+
+        struct xkb_keymap *keymap = *result;
+        std::string used = key;
+
+        if(!keymap){
+            wlr_log(WLR_ERROR, "Failed to compile the keymap %s, using the default one", key.c_str());
+
+            if(it != keymaps.end() && !it->second){
+                keymaps.erase(it);
+            }
+
+            keymap = keymap_cache_fallback(server, used);
+
+            if(!keymap){
+                return;
+            }
+        } else if(it != keymaps.end() && it->second){
+            //a new keyboard compiled it inline meanwhile
+            xkb_keymap_unref(keymap);
+            keymap = it->second;
+        } else{
+            keymaps[key] = keymap;
+        }
+
+        //every keyboard that still wants it, a reload might have moved some elsewhere
+        struct yawc_keyboard *keyboard;
+        wl_list_for_each(keyboard, &server->keyboards, link){
+            if(keyboard->keymap_key == key){
+                keyboard->keymap_key = used;
+                keymap_set(keyboard, keymap);
+            }
+        }
+    });
+}
+
+void keymap_cache_prune(struct yawc_server *server){
+    auto &keymaps = server->keymaps.keymaps;
+
+    std::erase_if(keymaps, [server](auto &entry){
+        if(!entry.second){
+            return false;
+        }
+
+        struct yawc_keyboard *keyboard;
+        wl_list_for_each(keyboard, &server->keyboards, link){
+            if(keyboard->keymap_key == entry.first){
+                return false;
+            }
+        }
+
+        xkb_keymap_unref(entry.second);
+
+        return true;
+    });
+}
+
+void keymap_cache_finish(struct yawc_server *server){
+    for(auto &[_, keymap]: server->keymaps.keymaps){
+        if(keymap){
+            xkb_keymap_unref(keymap);
+        }
+    }
+
+    server->keymaps.keymaps.clear();
+}
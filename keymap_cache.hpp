@@ -0,0 +1,19 @@
+#include <map>
+#include <string>
+
+struct xkb_keymap;
+struct yawc_server;
+struct yawc_keyboard;
+struct yawc_keyboard_config;
+
+//compiled keymaps keyed by the full rule names, shared by every keyboard using them
+struct yawc_keymap_cache {
+    std::map<std::string, struct xkb_keymap*> keymaps; // nullptr while a worker compiles it
+};
+
+//sets the keymap right away on a hit, a miss is compiled on a worker and applied when it's done
+void keymap_cache_apply(struct yawc_server *server, struct yawc_keyboard *keyboard, const struct yawc_keyboard_config &config);
+
+//drops the keymaps no keyboard uses anymore
+void keymap_cache_prune(struct yawc_server *server);
+void keymap_cache_finish(struct yawc_server *server);
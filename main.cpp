@@ -19,15 +19,20 @@ int main(int argc, char **argv){
         {"window-manager", required_argument, NULL, 'w'},
         {"startup", required_argument, NULL, 's'},
         {"config", required_argument, NULL, 'c'},
+        {"record", required_argument, NULL, 'r'},
+        {"replay", required_argument, NULL, 'p'},
+        {"replay-fast", no_argument, NULL, 'f'},
         {0, 0, 0, 0}
     };
 
-    char *wm_module_location, *startup_command, *custom_config_path; 
-    wm_module_location = startup_command = custom_config_path = nullptr;
+    char *wm_module_location, *startup_command, *custom_config_path, *record_path, *replay_path; 
+    wm_module_location = startup_command = custom_config_path = record_path = replay_path = nullptr;
+
+    bool replay_fast = false;
 
     int c, option_index;
 
-    while((c = getopt_long(argc, argv, "hw:s:c:", long_options, &option_index)) != -1){
+    while((c = getopt_long(argc, argv, "hw:s:c:r:p:f", long_options, &option_index)) != -1){
         switch(c){
             case 'w':
                 wm_module_location = optarg;
@@ -41,9 +46,21 @@ int main(int argc, char **argv){
                 custom_config_path = optarg;
                 break;
 
+            case 'r':
+                record_path = optarg;
+                break;
+
+            case 'p':
+                replay_path = optarg;
+                break;
+
+            case 'f':
+                replay_fast = true;
+                break;
+
             default:
             case 'h':
-                std::printf("%s","-w/--window-manager to pass a custom window manager\n-s/--startup to pass a startup command\n-c/--config to pass a custom config\n");
+                std::printf("%s","-w/--window-manager to pass a custom window manager\n-s/--startup to pass a startup command\n-c/--config to pass a custom config\n-r/--record to record the input to a file\n-p/--replay to replay a recorded input file and exit\n-f/--replay-fast to replay without the recorded timing\n");
                 return 0;
         } 
     }
@@ -77,8 +94,18 @@ int main(int argc, char **argv){
         server.config->wm_path = wm_module_location;
     }
 
+    if(record_path){
+        server.trace.record_path = record_path;
+    }
+
+    if(replay_path){
+        server.trace.replay_path = replay_path;
+        server.trace.replay_fast = replay_fast;
+    }
+
     if (server.run()) {
         wlr_log(WLR_ERROR, "Failed to start the compositor");
+        return 1;
     }
     
     return 0;
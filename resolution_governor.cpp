@@ -0,0 +1,218 @@
+#include "resolution_governor.hpp"
+
+#include "server.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+constexpr float SCALE_STEP = 0.25f;
+constexpr float DEFAULT_MIN_SCALE = 0.5f;
+
+constexpr int OVER_BUDGET_FRAMES = 4; // out of the last 8
+constexpr int HEADROOM_FRAMES = 120;
+constexpr int MAX_HEADROOM_FRAMES = 120 * 16;
+
+bool resolution_governor_active(struct yawc_output *output){
+    return output->governor.shadow_scene_output != nullptr;
+}
+
+void destroy_shadow(struct yawc_output *output){
+    auto *governor = &output->governor;
+
+    if(governor->shadow_scene_output){
+        wlr_scene_output_destroy(governor->shadow_scene_output);
+        governor->shadow_scene_output = nullptr;
+    }
+
+    if(governor->shadow){
+        wl_list_remove(&governor->shadow_destroy.link);
+
+        wlr_output_destroy(governor->shadow);
+        governor->shadow = nullptr;
+    }
+}
+
+//the headless backend can go first on shutdown, the scene cleans its own output up
+void handle_shadow_destroy(struct wl_listener *listener, void *data){
+    struct yawc_resolution_governor *governor = wl_container_of(listener, governor, shadow_destroy);
+
+    wl_list_remove(&governor->shadow_destroy.link);
+
+    governor->shadow = nullptr;
+    governor->shadow_scene_output = nullptr;
+}
+
+bool create_shadow(struct yawc_output *output, float factor){
+    auto *server = output->server;
+    auto *governor = &output->governor;
+    auto *wlr_output = output->wlr_output;
+
+    int width = std::max(1, (int)std::lround(wlr_output->width * factor));
+    int height = std::max(1, (int)std::lround(wlr_output->height * factor));
+
+    //a headless output nobody else sees, handle_new_output must not adopt it
+    server->creating_shadow_output = true;
+    governor->shadow = wlr_headless_add_output(server->headless_backend, width, height);
+    server->creating_shadow_output = false;
+
+    if(!governor->shadow){
+        return false;
+    }
+
+    governor->shadow_destroy.notify = handle_shadow_destroy;
+    wl_signal_add(&governor->shadow->events.destroy, &governor->shadow_destroy);
+
+    if(!wlr_output_init_render(governor->shadow, server->allocator, server->renderer)){
+        destroy_shadow(output);
+        return false;
+    }
+
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+    wlr_output_state_set_enabled(&state, true);
+    wlr_output_state_set_custom_mode(&state, width, height, wlr_output->refresh);
+    wlr_output_state_set_scale(&state, wlr_output->scale * factor);
+    wlr_output_state_set_transform(&state, wlr_output->transform);
+
+    bool ok = wlr_output_commit_state(governor->shadow, &state);
+    wlr_output_state_finish(&state);
+
+    if(!ok){
+        destroy_shadow(output);
+        return false;
+    }
+
+    //created after the real one so surfaces keep it as their primary output
+    governor->shadow_scene_output = wlr_scene_output_create(server->scene, governor->shadow);
+
+    if(!governor->shadow_scene_output){
+        destroy_shadow(output);
+        return false;
+    }
+
+    return true;
+}
+
+void set_factor(struct yawc_output *output, float factor){
+    auto *governor = &output->governor;
+
+    bool consistent = (factor < 1.0f) == resolution_governor_active(output);
+
+    if(factor == governor->factor && consistent){
+        return;
+    }
+
+    destroy_shadow(output);
+
+    if(factor < 1.0f && !create_shadow(output, factor)){
+        wlr_log(WLR_ERROR, "Failed to create the reduced buffer for %s", output->wlr_output->name);
+        factor = 1.0f;
+    }
+
+    wlr_log(WLR_INFO, "Rendering %s at %.0f%% resolution", output->wlr_output->name, factor * 100);
+
+    governor->factor = factor;
+    governor->over_budget_history = 0;
+    governor->headroom_frames = 0;
+    governor->last_change_ns = utils::now_ns();
+
+    if(factor == 1.0f){
+        //the blits overwrote the swapchain behind the native scene output's back
+        output->damage_whole = true;
+    }
+
+    wlr_output_schedule_frame(output->wlr_output);
+}
+
+void resolution_governor_finish(struct yawc_output *output){
+    destroy_shadow(output);
+
+    output->governor = {};
+}
+
+bool resolution_governor_build_state(struct yawc_output *output, struct wlr_output_state *state){
+    auto *governor = &output->governor;
+    auto *server = output->server;
+
+    wlr_scene_output_set_position(governor->shadow_scene_output, output->scene_output->x, output->scene_output->y);
+
+    struct wlr_output_state shadow_state;
+    wlr_output_state_init(&shadow_state);
+
+    if(!wlr_scene_output_build_state(governor->shadow_scene_output, &shadow_state, NULL) || !shadow_state.buffer){
+        wlr_output_state_finish(&shadow_state);
+        return false;
+    }
+
+    struct wlr_buffer *buffer = wlr_buffer_lock(shadow_state.buffer);
+
+    //rotates the swapchain and the damage ring of the intermediate output
+    wlr_output_commit_state(governor->shadow, &shadow_state);
+    wlr_output_state_finish(&shadow_state);
+
+    bool ok = utils::blit_buffer_to_output(output, state, buffer);
+
+    wlr_buffer_unlock(buffer);
+
+    return ok;
+}
+
+void resolution_governor_committed(struct yawc_output *output, int64_t start_ns, int64_t end_ns){
+    auto *governor = &output->governor;
+
+    governor->start_ns = start_ns;
+    governor->cost_ns = end_ns - start_ns;
+}
+
+void resolution_governor_presented(struct yawc_output *output, struct wlr_output_event_present *event){
+    auto *governor = &output->governor;
+    int64_t refresh = event->refresh;
+
+    if(!output->config.adaptive_resolution.value_or(false)){
+        if(resolution_governor_active(output)){
+            set_factor(output, 1.0f);
+        }
+
+        return;
+    }
+
+    if(!event->presented || !governor->start_ns || !refresh 
+            || output->wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED){
+        governor->start_ns = 0;
+        return;
+    }
+
+    if(!governor->factor){
+        governor->factor = 1.0f;
+        governor->required_headroom = HEADROOM_FRAMES;
+    }
+
+    int64_t latency = utils::timespec_to_ns(event->when) - governor->start_ns;
+    governor->start_ns = 0;
+
+    //either the cpu side ate the interval or the gpu made us miss the vblank we aimed at
+    bool over_budget = governor->cost_ns > refresh * 9 / 10 || latency > refresh + refresh / 4;
+    bool headroom = !over_budget && governor->cost_ns < refresh / 3;
+
+    governor->over_budget_history = (governor->over_budget_history << 1) | over_budget;
+
+    float min_scale = std::clamp(output->config.min_render_scale.value_or(DEFAULT_MIN_SCALE), SCALE_STEP, 1.0f);
+
+    if(std::popcount((uint8_t)governor->over_budget_history) >= OVER_BUDGET_FRAMES && governor->factor > min_scale){
+        //going back up was premature, wait longer next time
+        if(utils::now_ns() - governor->last_change_ns < 2000000000LL){
+            governor->required_headroom = std::min(governor->required_headroom * 2, MAX_HEADROOM_FRAMES);
+        }
+
+        set_factor(output, std::max(governor->factor - SCALE_STEP, min_scale));
+        return;
+    }
+
+    governor->headroom_frames = headroom ? governor->headroom_frames + 1 : 0;
+
+    if(governor->factor < 1.0f && governor->headroom_frames >= governor->required_headroom){
+        set_factor(output, std::min(governor->factor + SCALE_STEP, 1.0f));
+    }
+}
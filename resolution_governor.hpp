@@ -0,0 +1,15 @@
+#include <cstdint>
+
+struct yawc_output;
+struct wlr_output_state;
+struct wlr_output_event_present;
+
+void resolution_governor_finish(struct yawc_output *output);
+
+bool resolution_governor_active(struct yawc_output *output);
+
+//composites into the reduced intermediate buffer and upscales it into state
+bool resolution_governor_build_state(struct yawc_output *output, struct wlr_output_state *state);
+
+void resolution_governor_committed(struct yawc_output *output, int64_t start_ns, int64_t end_ns);
+void resolution_governor_presented(struct yawc_output *output, struct wlr_output_event_present *event);
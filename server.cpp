@@ -2,39 +2,85 @@
 
 #include "shm_alloc/shm.hpp"
 #include "utils.hpp"
+#include "visibility.hpp"
 
+#include <algorithm>
 #include <dlfcn.h>
 #include <signal.h>
 #include <unistd.h>
 
-int handle_sig_restart(int sig, void *data){
-    yawc_server *server = reinterpret_cast<yawc_server*>(data);
-    auto *cfg = server->config;
+void schedule_output_topology_update(struct yawc_server *server);
+
+void yawc_server::reload_config(){
+    auto *cfg = this->config;
 
     cfg->load(cfg->last_path.c_str());
 
     yawc_pointer *pointer;
-    wl_list_for_each(pointer, &server->pointers, link){
-        server->load_pointer_cfg(pointer);
+    wl_list_for_each(pointer, &this->pointers, link){
+        this->load_pointer_cfg(pointer);
     }
 
     yawc_keyboard *keyboard;
-    wl_list_for_each(keyboard, &server->keyboards, link){
-        server->load_keyboard_cfg(keyboard);
+    wl_list_for_each(keyboard, &this->keyboards, link){
+        this->load_keyboard_cfg(keyboard);
+    }
+
+    keymap_cache_prune(this);
+
+    yawc_output *output;
+    wl_list_for_each(output, &this->outputs, link){
+        this->load_output_cfg(output);
     }
 
+    this->update_virtual_outputs();
+
+    //picks up mirror changes
+    schedule_output_topology_update(this);
+
+    utils::update_output_occupants(this);
+
+    damage_debug_set_enabled(this, cfg->debug.damage);
+
     if(!cfg->wm_path.empty() 
-            && server->wm.hash != utils::hash_file_fnv1a(cfg->wm_path)){
+            && this->wm.hash != utils::hash_file_fnv1a(cfg->wm_path)){
         wlr_log(WLR_INFO, "Reloading the window manager: %s", cfg->wm_path.c_str());
 
-        server->load_wm(cfg->wm_path.c_str());
+        this->load_wm(cfg->wm_path.c_str());
     }
 
-    if(server->keybind_manager){
-        server->keybind_manager->reload();
+    if(this->keybind_manager){
+        this->keybind_manager->reload();
     }
 
     wlr_log(WLR_INFO, "Reloaded the config");
+}
+
+int handle_sig_restart(int sig, void *data){
+    yawc_server *server = reinterpret_cast<yawc_server*>(data);
+
+    server->reload_config();
+
+    return 0;
+}
+
+int handle_sig_dump_stats(int sig, void *data){
+    yawc_server *server = reinterpret_cast<yawc_server*>(data);
+
+    if(!frame_stats_dump(server, server->frame_stats_path)){
+        wlr_log(WLR_ERROR, "Failed to write the frame stats to %s", server->frame_stats_path.c_str());
+    }
+
+    return 0;
+}
+
+//leave the loop so the destructor runs, the input trace and the like get written out
+int handle_sig_terminate(int sig, void *data){
+    yawc_server *server = reinterpret_cast<yawc_server*>(data);
+
+    wlr_log(WLR_INFO, "Got signal %d, exiting", sig);
+
+    wl_display_terminate(server->wl_display);
 
     return 0;
 }
@@ -87,6 +133,19 @@ yawc_server::yawc_server(){
     wl_list_init(&this->inhibitors);
 
     this->reload_event = wl_event_loop_add_signal(this->wl_event_loop, SIGUSR1, handle_sig_restart, this);
+
+    //blocking loads only (cursor themes, keymaps), nothing on the render path
+    size_t worker_count = std::clamp(std::thread::hardware_concurrency(), 1u, 2u);
+
+    if(!worker_pool_init(&this->workers, this->wl_event_loop, worker_count)){
+        wlr_log(WLR_ERROR, "Failed to start the worker threads, running everything inline");
+    }
+
+    this->frame_stats_path = "/tmp/yawc_frame_stats.log";
+    this->stats_event = wl_event_loop_add_signal(this->wl_event_loop, SIGUSR2, handle_sig_dump_stats, this);
+
+    this->sigint_event = wl_event_loop_add_signal(this->wl_event_loop, SIGINT, handle_sig_terminate, this);
+    this->sigterm_event = wl_event_loop_add_signal(this->wl_event_loop, SIGTERM, handle_sig_terminate, this);
     this->keybind_manager = nullptr;
 }
 
@@ -98,6 +157,8 @@ yawc_server::~yawc_server()
         delete this->keybind_manager;
     }
 
+    input_trace_finish(this);
+
     if(this->shortcuts_manager) {
         wl_list_remove(&this->new_shortcut.link);
     }
@@ -110,6 +171,38 @@ yawc_server::~yawc_server()
         wl_event_source_remove(this->reload_event);
     }
 
+    if(this->stats_event){
+        wl_event_source_remove(this->stats_event);
+    }
+
+    if(this->sigint_event){
+        wl_event_source_remove(this->sigint_event);
+    }
+
+    if(this->sigterm_event){
+        wl_event_source_remove(this->sigterm_event);
+    }
+
+    visibility_finish(this);
+
+    hit_index_finish(this);
+
+    if(this->damage_new_surface.notify){
+        wl_list_remove(&this->damage_new_surface.link);
+    }
+
+    worker_pool_finish(&this->workers);
+
+    keymap_cache_finish(this);
+
+    if(this->hotplug_timer){
+        wl_event_source_remove(this->hotplug_timer);
+    }
+
+    if(this->pending_motion.idle){
+        wl_event_source_remove(this->pending_motion.idle);
+    }
+
     if (this->output_power_manager) {
         wl_list_remove(&this->output_power_manager_set_mode.link);
     }
@@ -196,6 +289,12 @@ bool yawc_server::create_scene()
         return false;
     }
 
+    this->tearing_control_manager = wlr_tearing_control_manager_v1_create(this->wl_display, 1);
+    if(!this->tearing_control_manager){
+        wlr_log(WLR_ERROR, "Failed to create the tearing control manager");
+        return false;
+    }
+
     this->gamma_control_manager = wlr_gamma_control_manager_v1_create(this->wl_display);
     if(!this->gamma_control_manager){
         wlr_log(WLR_ERROR, "Failed to create the gamma control manager");
@@ -227,8 +326,15 @@ yawc_server_error yawc_server::run() {
 		wlr_scene_set_linux_dmabuf_v1(this->scene, this->linux_dmabuf_v1);
 	}
 
+    hit_index_init(this);
+
+    damage_debug_init(this);
+    damage_debug_set_enabled(this, this->config->debug.damage);
+
     create_xdg_shell();
 
+    visibility_init(this);
+
     create_idle_manager();
     create_decoration_manager();
     create_session_lock_manager();
@@ -259,11 +365,18 @@ yawc_server_error yawc_server::run() {
 
     setenv("WAYLAND_DISPLAY", socket, true);
 
+    //before the backend starts, it announces the devices it already has
+    if(!this->trace.record_path.empty() && !input_trace_record_start(this)){
+        return yawc_server_error::FAILED_TO_START_TRACE;
+    }
+
     err = setup_backend();
 	if(err != yawc_server_error::OK){
 		return err;
 	}
 
+    this->update_virtual_outputs();
+
     if (!this->config->autostart_cmds.empty()) {
         for(auto &cmd: this->config->autostart_cmds){
             utils::exec(cmd.c_str());
@@ -274,6 +387,11 @@ yawc_server_error yawc_server::run() {
         this->load_wm(this->config->wm_path.c_str());
     }
 
+    //a replay that can't start would leave us running with nothing to stop us
+    if(!this->trace.replay_path.empty() && !input_trace_replay_start(this)){
+        return yawc_server_error::FAILED_TO_START_TRACE;
+    }
+
     wl_display_run(this->wl_display);
 
     return yawc_server_error::OK;
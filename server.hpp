@@ -1,5 +1,7 @@
+#include <bitset>
 #include <string>
 #include <map>
+#include <vector>
 
 #include <wayland-client.h>
 #include <wayland-server-protocol.h>
@@ -8,6 +10,12 @@
 #include <xcb/xcb.h>
 
 #include "config.hpp"
+#include "damage_debug.hpp"
+#include "frame_stats.hpp"
+#include "hit_index.hpp"
+#include "input_trace.hpp"
+#include "keymap_cache.hpp"
+#include "worker_pool.hpp"
 #include "wm_api.h"
 
 #define static
@@ -61,6 +69,7 @@ extern "C" {
 #include <wlr/types/wlr_cursor_shape_v1.h>
 #include <wlr/types/wlr_presentation_time.h>
 #include <wlr/types/wlr_content_type_v1.h>
+#include <wlr/types/wlr_tearing_control_v1.h>
 #include <wlr/types/wlr_gamma_control_v1.h>
 #include <wlr/types/wlr_xdg_foreign_registry.h>
 #include <wlr/types/wlr_xdg_foreign_v1.h>
@@ -78,12 +87,14 @@ enum yawc_server_error { OK = 0,
     FAILED_TO_CREATE_SOCKET,
     IS_NOT_GLES2,
     COULDNT_CREATE_HEADLESS,
-    COULDNT_CREATE_SCENE
+    COULDNT_CREATE_SCENE,
+    FAILED_TO_START_TRACE
 };
 
 struct yawc_pointer {
 public:
     struct wl_list link;
+    struct yawc_server* server;
     struct wlr_input_device* wlr_device;
 
     struct wl_listener destroy;
@@ -95,6 +106,8 @@ public:
     struct yawc_server* server;
     struct wlr_keyboard* wlr_keyboard;
 
+    std::string keymap_key; // the keymap it wants from the cache
+
     struct wl_listener modifiers;
     struct wl_listener key;
     struct wl_listener destroy;
@@ -112,6 +125,43 @@ struct yawc_session_lock {
 	struct wl_listener destroy;
 };
 
+struct yawc_frame_scheduler {
+    struct wl_event_source *timer;
+
+    int64_t refresh_ns; // 0 when the refresh rate is unknown or variable
+    int64_t last_presentation_ns;
+
+    //predicted cost of building and committing a frame
+    int64_t render_cost_ns;
+    int64_t margin_ns;
+
+    int64_t target_vblank_ns; // vblank the in-flight frame was aimed at
+
+    bool waiting;
+};
+
+//learned from the first async flip, forgotten on mode or config changes
+enum yawc_tearing_capability { TEARING_UNKNOWN = 0,
+    TEARING_SUPPORTED,
+    TEARING_UNSUPPORTED
+};
+
+struct yawc_resolution_governor {
+    //reduced resolution twin of the output, only exists while scaled down
+    struct wlr_output *shadow;
+    struct wlr_scene_output *shadow_scene_output;
+
+    struct wl_listener shadow_destroy;
+
+    float factor; // 0 until the first presented frame
+
+    int64_t start_ns, cost_ns; // last committed frame
+    int64_t last_change_ns;
+
+    uint8_t over_budget_history; // one bit per frame
+    int headroom_frames, required_headroom;
+};
+
 struct yawc_output {
 public:
     struct wlr_output* wlr_output;
@@ -119,12 +169,43 @@ public:
 
     struct yawc_server* server;
 
+    struct yawc_output_config config;
+
+    struct yawc_frame_scheduler scheduler;
+    struct yawc_resolution_governor governor;
+    struct yawc_frame_stats stats;
+    struct yawc_damage_stats damage;
+
+    enum yawc_tearing_capability tearing;
+
+    //fullscreen toplevel covering this output, if any
+    struct yawc_toplevel *occupant;
+
+    //policy for the occupant content type, only re-evaluated on focus and fullscreen changes
+    std::optional<struct yawc_content_type_policy> policy;
+
+    std::optional<bool> pending_adaptive_sync; // applied with the next frame
+    bool forced_adaptive_sync;
+
     struct timespec last_frame;
 
     int last_width, last_height;
 
+    bool pending_layout; // waiting for the hotplug batch to end
+
+    //mirror target: no scene output, shows the last frame of mirror_source
+    struct yawc_output *mirror_source;
+    uint64_t mirror_seq_shown;
+
+    //mirror source: last committed frame, kept while something mirrors us
+    struct wlr_buffer *mirror_buffer;
+    uint64_t mirror_seq;
+    bool mirror_cursor_locked; // cursors must be in the frame we hand to the targets
+
     float last_scale;
 
+    bool damage_whole; // repaint and present all of it next frame, the scene has no call for that
+
     struct wl_list layer_surfaces;
     struct wl_list link;
 
@@ -132,6 +213,7 @@ public:
     struct wl_listener frame;
     struct wl_listener request_state;
     struct wl_listener commit;
+    struct wl_listener present;
 };
 
 struct yawc_input_on_surface {
@@ -173,24 +255,29 @@ struct yawc_xwayland_manager{
                            *death;
 };
 
+constexpr uint32_t YAWC_KEYCODE_COUNT = 1024; // xkb keycodes, KEY_MAX + 8 fits
+constexpr int YAWC_KEYBIND_SEQUENCE_TIMEOUT_MS = 1000;
+
 struct yawc_keybind_manager{
     yawc_keybind_manager(struct yawc_server *server);
+    ~yawc_keybind_manager();
 
     struct yawc_server *server;
 
     struct yawc_global_shortcut *cur_global_shortcut;
-    uint32_t cur_pressed_button;
+    uint32_t cur_pressed_key; // keycode that triggered it
 
     std::string global_shortcut_path;
 
-    std::set<uint32_t> pressed_keys;
+    std::bitset<YAWC_KEYCODE_COUNT> pressed_keys;
 
-    struct yawc_bind_node *cur_node;
-    time_t last_time;
+    uint32_t cur_state; // index into config->keybinds.states
+    struct wl_event_source *sequence_timer; // drops a sequence nobody finished
     
     bool needed();
     bool in_sequence();
-    void store(uint32_t button, uint32_t modifiers, bool pressed);
+    void set_state(uint32_t state);
+    void store(uint32_t keycode, uint32_t sym, uint32_t modifiers, bool pressed);
     struct yawc_bind_node *triggered();
     void execute_action(struct yawc_bind_node *node, uint32_t trigger);
     void reload();
@@ -237,6 +324,10 @@ public:
     struct wlr_cursor* cursor = nullptr;
     struct wlr_xcursor_manager* cursor_mgr = nullptr;
 
+    //last named image we set, empty when a client surface or nothing is shown
+    std::string cursor_image;
+    std::vector<float> cursor_scales_loading;
+
     struct wlr_xdg_decoration_manager_v1 *decoration_manager;
     struct wlr_idle_inhibit_manager_v1 *idle_inhibit_manager;
     struct wlr_idle_notifier_v1 *idle_notify_manager;
@@ -249,6 +340,7 @@ public:
     struct wlr_pointer_constraint_v1 *active_constraint = nullptr;
 
     struct wlr_content_type_manager_v1 *content_type_manager;
+    struct wlr_tearing_control_manager_v1 *tearing_control_manager;
     struct wlr_data_device_manager *data_device_manager;
     struct wlr_primary_selection_v1_device_manager *primary_selection_manager;
 
@@ -260,7 +352,21 @@ public:
 
 	struct wlr_linux_dmabuf_v1 *linux_dmabuf_v1;
 
-    struct wl_event_source *reload_event;
+    struct wl_event_source *reload_event, *stats_event;
+    struct wl_event_source *sigint_event, *sigterm_event;
+
+    struct yawc_worker_pool workers;
+    struct wl_event_source *visibility_timer = nullptr; // armed only while something is suspended
+    struct wl_event_source *visibility_idle = nullptr;
+    bool visibility_timer_armed = false;
+    struct wl_event_source *hotplug_timer = nullptr;
+
+    std::string frame_stats_path;
+    struct yawc_input_latency input_latency;
+
+    struct yawc_keymap_cache keymaps;
+
+    struct yawc_input_trace trace;
 
     struct yawc_keybind_manager *keybind_manager;
 
@@ -326,8 +432,8 @@ public:
     double grabbed_res_x, grabbed_res_y;
     struct wlr_box grabbed_geo_box;
     uint32_t resize_edges;
-    struct yawc_toplevel* grabbed_toplevel;
-    enum yawc_mouse_operation current_mouse_operation;
+    struct yawc_toplevel* grabbed_toplevel = nullptr;
+    enum yawc_mouse_operation current_mouse_operation = NOTHING;
 
     yawc_server();
 
@@ -370,9 +476,22 @@ public:
     yawc_pointer *handle_pointer(struct wlr_input_device *device);
     void load_keyboard_cfg(yawc_keyboard *keyboard);
     void load_pointer_cfg(yawc_pointer *pointer);
+    void load_output_cfg(yawc_output *output);
+    void reload_config(); // SIGUSR1
 
     void handle_new_input(struct wl_listener*, void*);
     void handle_pointer_motion(struct wl_listener*, void*, bool);
+    void process_pointer_motion(struct wlr_input_device *device, double dx, double dy, uint32_t time);
+
+    //relative motion summed up until the event loop is idle, clients see one motion per batch
+    struct {
+        struct wlr_input_device *device;
+        double dx, dy;
+        uint32_t time;
+        bool queued, frame;
+        struct wl_event_source *idle;
+    } pending_motion = {};
+    void flush_pointer_motion();
 
     bool do_mouse_operation();
 
@@ -402,4 +521,15 @@ public:
     
     //we actually need this
     struct yawc_output *fallback_output;
+
+    //headless outputs from the config, in config order
+    std::vector<struct wlr_output*> virtual_outputs;
+    void update_virtual_outputs();
+
+    bool creating_shadow_output = false;
+
+    struct wl_listener damage_new_surface = {};
+
+    struct yawc_hit_index hit_index;
+    bool damage_debug = false;
 };
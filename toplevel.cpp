@@ -6,6 +6,8 @@
 
 #include "window_ops.hpp"
 
+#include "visibility.hpp"
+
 static uint64_t current_id = 0;
 
 void handle_toplevel_foreign_activate(struct wl_listener* listener, void* data){
@@ -62,12 +64,10 @@ void yawc_toplevel::send_geometry_update(){
 	    }
 
         if(server->wm.handle && server->wm.callbacks.on_geometry){
-            wm_toplevel wm_tl {this};
-
             wm_box_t last_box {last_geo->x, last_geo->y, last_geo->width, last_geo->height};
             wm_box_t cur_box {geo.x, geo.y, geo.width, geo.height};
 
-            server->wm.callbacks.on_geometry(&wm_tl, last_box, cur_box);
+            server->wm.callbacks.on_geometry(wm_toplevel_handle(this), last_box, cur_box);
         }
 
         if(!this->maximized && !this->fullscreen){
@@ -119,10 +119,10 @@ void yawc_toplevel::map(){
 
     this->mapped = true;
 
-    if(server->wm.handle && server->wm.callbacks.on_map){
-        wm_toplevel wm_tl {this};
+    visibility_track_toplevel(this);
 
-        server->wm.callbacks.on_map(&wm_tl);
+    if(server->wm.handle && server->wm.callbacks.on_map){
+        server->wm.callbacks.on_map(wm_toplevel_handle(this));
 
         return;
     }   
@@ -142,9 +142,7 @@ void yawc_toplevel::unmap(){
     }
 
     if(server->wm.handle && server->wm.callbacks.on_unmap){
-        wm_toplevel wm_tl {this};
-
-        server->wm.callbacks.on_unmap(&wm_tl);
+        server->wm.callbacks.on_unmap(wm_toplevel_handle(this));
     }
 
     if(this->foreign_handle){
@@ -162,16 +160,27 @@ void yawc_toplevel::unmap(){
     }
 
     this->mapped = false;
+
+    utils::update_output_occupants(this->server);
 }
 
 void yawc_toplevel::commit(){
     const char *current_title = this->xdg_toplevel->title;
     const char *current_app_id = this->xdg_toplevel->app_id;
 
-    if(server->wm.handle && server->wm.callbacks.on_commit){
-        wm_toplevel wm_tl {this}; 
+    this->apply_resize_moves();
+
+    //caught up with the last resize, it can have the newest size now
+    if(this->resize.serial && (int32_t)(this->xdg_toplevel->base->current.configure_serial - this->resize.serial) >= 0){
+        this->resize.serial = 0;
+
+        if(!server->config->performance.resize_configure_per_frame){
+            this->flush_interactive_resize();
+        }
+    }
 
-        server->wm.callbacks.on_commit(&wm_tl);
+    if(server->wm.handle && server->wm.callbacks.on_commit){
+        server->wm.callbacks.on_commit(wm_toplevel_handle(this));
     }
 
     if(!this->mapped){
@@ -189,12 +198,10 @@ void yawc_toplevel::request_maximize(bool enable){
     utils::wake_up_from_idle(this->server);
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-
         wm_toggle_request_payload payload {enable};
 
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_MAXIMIZE, &payload);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_MAXIMIZE, &payload);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -208,12 +215,10 @@ void yawc_toplevel::request_minimize(bool enable){
     utils::wake_up_from_idle(this->server);
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-
         wm_toggle_request_payload payload{enable};
 
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_MINIMIZE, &payload);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_MINIMIZE, &payload);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -227,11 +232,10 @@ void yawc_toplevel::request_fullscreen(bool enable){
     utils::wake_up_from_idle(this->server);
 
     if (server->wm.handle && server->wm.callbacks.on_toplevel_request_event) {
-        wm_toplevel wm_tl {this};
         wm_toggle_request_payload payload {enable};
 
         auto cevent = 
-            wm_create_toplevel_request_event(&wm_tl, WM_REQUEST_FULLSCREEN, &payload);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), WM_REQUEST_FULLSCREEN, &payload);
         
         server->wm.callbacks.on_toplevel_request_event(&cevent);
         return; 
@@ -248,10 +252,8 @@ void yawc_toplevel::request_move(){
     utils::wake_up_from_idle(this->server);
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_MOVE, NULL);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_MOVE, NULL);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -275,12 +277,10 @@ void yawc_toplevel::request_resize(uint32_t edges){
     auto *server = this->server;
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-        
         wm_resize_request_payload payload{edges};
 
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_RESIZE, &payload);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_RESIZE, &payload);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -296,10 +296,8 @@ void yawc_toplevel::request_activate(){
     utils::wake_up_from_idle(server);
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_ACTIVATE, NULL);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_ACTIVATE, NULL);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -317,10 +315,8 @@ void yawc_toplevel::request_close(){
     utils::wake_up_from_idle(server);
 
     if(server->wm.handle && server->wm.callbacks.on_toplevel_request_event){
-        wm_toplevel ctoplevel {this};
-
         auto cevent = 
-            wm_create_toplevel_request_event(&ctoplevel, wm_toplevel_request_type_t::WM_REQUEST_CLOSE, NULL);
+            wm_create_toplevel_request_event(wm_toplevel_handle(this), wm_toplevel_request_type_t::WM_REQUEST_CLOSE, NULL);
 
         server->wm.callbacks.on_toplevel_request_event(&cevent);
 
@@ -335,6 +331,7 @@ struct yawc_toplevel_geometry yawc_toplevel::reset_state(){
 
     wlr_scene_node_set_position(&this->scene_tree->node, last_geo.x,
         last_geo.y);
+    hit_index_update(this->server, &this->scene_tree->node);
 
     wlr_xdg_toplevel_set_size(this->xdg_toplevel, 
         last_geo.width, last_geo.height);
@@ -467,6 +464,8 @@ yawc_toplevel *create_toplevel_xdg(yawc_server *server, struct wlr_xdg_toplevel
 
     xdg_toplevel->base->data = toplevel->scene_tree;
 
+    hit_index_update(server, &toplevel->scene_tree->node);
+
     toplevel->has_resize_grips = false;
     
     toplevel->wm_state = nullptr;
@@ -480,5 +479,16 @@ yawc_toplevel *create_toplevel_xdg(yawc_server *server, struct wlr_xdg_toplevel
 yawc_toplevel::~yawc_toplevel(){
     wl_list_remove(&this->link);
 
+    wm_release_toplevel_handle(this);
+
+    visibility_untrack_toplevel(this);
+
+    struct yawc_output *output;
+    wl_list_for_each(output, &this->server->outputs, link){
+        if(output->occupant == this){
+            output->occupant = nullptr;
+        }
+    }
+
     wlr_scene_node_destroy(&this->image_capture_scene->tree.node);
 }
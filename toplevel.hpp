@@ -4,6 +4,12 @@ struct yawc_toplevel_geometry{
     int x, y, width, height;
 };
 
+//top/left edge resizes move the window, but only once the client draws the new size
+struct yawc_resize_move {
+    uint32_t serial;
+    int x, y; // window geometry position
+};
+
 struct yawc_toplevel_decoration{
     struct yawc_toplevel *toplevel;
     struct wlr_xdg_toplevel_decoration_v1 *xdg_decoration;
@@ -28,6 +34,7 @@ struct yawc_toplevel {
     struct yawc_toplevel_decoration *decoration;
 
     void *wm_state;
+    struct wm_toplevel *wm_handle = nullptr; // see wm_toplevel_handle
 
     uint64_t id;
 
@@ -37,6 +44,12 @@ struct yawc_toplevel {
     bool maximized : 1;
     bool mapped : 1;
     bool fullscreen : 1;
+    bool suspended : 1; // nothing of it is on screen
+
+    int64_t last_hidden_frame_ns;
+
+    struct wlr_scene_buffer *surface_buffer = nullptr; // main surface in scene_tree, see visibility_track_toplevel
+    struct wl_listener surface_outputs_update, surface_buffer_destroy;
 
     struct wlr_foreign_toplevel_handle_v1 *foreign_handle;
     struct wlr_scene_buffer *foreign_on_output_handler; // ...
@@ -87,6 +100,25 @@ struct yawc_toplevel {
     struct yawc_toplevel_geometry reset_state();
     struct yawc_toplevel_geometry save_state();
 
+    //interactive resizes keep at most one configure in flight, the newest size waits for the ack
+    struct {
+        uint32_t serial; // configure the client hasn't committed yet, 0 = none
+        int64_t sent_ns;
+
+        bool pending;
+        bool pending_move;
+        int width, height;
+        int x, y;
+
+        std::vector<struct yawc_resize_move> moves; // per sent configure, oldest first
+    } resize;
+
+    void interactive_resize(int width, int height);
+    void interactive_resize(int x, int y, int width, int height);
+    bool resize_in_flight();
+    void flush_interactive_resize();
+    void apply_resize_moves();
+
     struct wlr_scene_tree* scene_tree;
 
     struct {
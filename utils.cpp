@@ -7,6 +7,8 @@
 #include <sys/wait.h>
 
 #include "utils.hpp"
+#include "content_policy.hpp"
+#include "visibility.hpp"
 
 #include "layer.hpp"
 #include "toplevel.hpp"
@@ -14,70 +16,37 @@
 std::tuple<yawc_toplevel*, yawc_input_on_surface>
 utils::desktop_toplevel_at(yawc_server* server, double lx, double ly)
 {
-    double sx, sy;
+    // in case we're grabbing an icon we cant have the drag icon annoying us, the default mask skips it
+    const struct yawc_hit_result *hit = hit_index_resolve(server, lx, ly);
 
-    if(server->drag.running){
-        wlr_scene_node_set_enabled(&server->drag.icons->node, false);
-    }
-
-    struct wlr_scene_node* node = wlr_scene_node_at(&server->scene->tree.node, lx, ly, &sx, &sy);
-
-    if(server->drag.running){ // in case we're grabbing an icon we cant have the drag icon annoying us
-        wlr_scene_node_set_enabled(&server->drag.icons->node, true);
-    }
-
-    if (node == NULL || node->type != WLR_SCENE_NODE_BUFFER) {
-        return {};
-    }
-
-    struct wlr_scene_buffer* scene_buffer = wlr_scene_buffer_from_node(node);
-    struct wlr_scene_surface* scene_surface = wlr_scene_surface_try_from_buffer(scene_buffer);
-
-    if (!scene_surface) {
+    if (!hit->surface) {
         return {};
     }
 
     yawc_input_on_surface out;
 
-    out.surface = scene_surface->surface;
-    out.x = sx;
-    out.y = sy;
+    out.surface = hit->surface;
+    out.x = hit->sx;
+    out.y = hit->sy;
 
-    struct wlr_scene_tree* tree = node->parent;
-    while (tree != NULL && tree->node.data == NULL) {
-        tree = tree->node.parent;
-    }
-
-    if (tree == NULL) {
-        return std::make_tuple(nullptr, out);
-    }
-    
-    auto desc = scene_descriptor_try_get(&tree->node, YAWC_SCENE_DESC_VIEW);
-
-    if(!desc){
-        return std::make_tuple(nullptr, out);
-    }
-
-    return std::make_tuple(static_cast<struct yawc_toplevel*>(desc->parent), out);
+    return std::make_tuple(hit->toplevel, out);
 }
 
 std::tuple<wlr_scene_node*, yawc_input_on_node>
 utils::desktop_node_at(yawc_server* server, double lx, double ly)
 {
-    double sx, sy;
-
-    struct wlr_scene_node* node = wlr_scene_node_at(&server->scene->tree.node, lx, ly, &sx, &sy);
+    const struct yawc_hit_result *hit = hit_index_resolve(server, lx, ly);
 
-    if (!node) {
+    if (!hit->node) {
         return std::make_tuple(nullptr, yawc_input_on_node{0,0});
     }
 
     yawc_input_on_node out;
 
-    out.x = sx;
-    out.y = sy;
+    out.x = hit->sx;
+    out.y = hit->sy;
 
-    return std::make_tuple(node, out);
+    return std::make_tuple(hit->node, out);
 }
 
 struct yawc_toplevel *utils::previous_toplevel(struct yawc_server *server){
@@ -131,6 +100,8 @@ void utils::focus_toplevel(struct yawc_toplevel* toplevel)
         if(toplevel->fullscreen){
             wlr_scene_node_reparent(&toplevel->scene_tree->node, server->layers.fullscreen);
         }
+
+        hit_index_update(server, &toplevel->scene_tree->node);
     }
 
     wl_list_remove(&toplevel->link);
@@ -145,6 +116,8 @@ void utils::focus_toplevel(struct yawc_toplevel* toplevel)
         server->pointer_constraints, surface, server->seat);
 
     server->constrain_cursor(req);
+
+    utils::update_output_occupants(server);
 }
 
 bool utils::toplevel_not_empty(struct yawc_toplevel* toplevel)
@@ -190,6 +163,49 @@ utils::get_output_of_toplevel(struct yawc_toplevel* toplevel)
     return nullptr;
 }
 
+struct yawc_output* utils::output_at_cursor(struct yawc_server *server){
+    auto *wlr_output = wlr_output_layout_output_at(server->output_layout, server->cursor->x, server->cursor->y);
+
+    if(!wlr_output){
+        return nullptr;
+    }
+
+    return static_cast<struct yawc_output*>(wlr_output->data);
+}
+
+void utils::update_output_occupants(struct yawc_server *server){
+    struct yawc_output *output;
+    wl_list_for_each(output, &server->outputs, link){
+        output->occupant = nullptr;
+    }
+
+    //toplevels are kept in focus order, so the first one wins
+    struct yawc_toplevel *toplevel;
+    wl_list_for_each(toplevel, &server->toplevels, link){
+        if(!toplevel->mapped || !toplevel->fullscreen || !toplevel->scene_tree){
+            continue;
+        }
+
+        struct wlr_scene_node *node = &toplevel->scene_tree->node;
+
+        if(!node->enabled || node->parent != server->layers.fullscreen){
+            continue;
+        }
+
+        output = utils::get_output_of_toplevel(toplevel);
+
+        if(output && !output->occupant){
+            output->occupant = toplevel;
+        }
+    }
+
+    wl_list_for_each(output, &server->outputs, link){
+        content_policy_update(output);
+    }
+
+    visibility_update(server);
+}
+
 bool utils::pointer_pressed(struct wlr_pointer_button_event *event){
     return event->state == wl_pointer_button_state::WL_POINTER_BUTTON_STATE_PRESSED && event->button == BTN_LEFT;
 }
@@ -302,3 +318,52 @@ uint64_t utils::hash_file_fnv1a(const std::string& path) {
     }
     return hash;
 }
+
+int64_t utils::timespec_to_ns(const struct timespec &ts){
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t utils::now_ns(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return timespec_to_ns(now);
+}
+
+bool utils::blit_buffer_to_output(struct yawc_output *output, struct wlr_output_state *state, struct wlr_buffer *buffer){
+    auto *wlr_output = output->wlr_output;
+
+    struct wlr_texture *texture = wlr_texture_from_buffer(output->server->renderer, buffer);
+
+    if(!texture){
+        return false;
+    }
+
+    struct wlr_render_pass *pass = wlr_output_begin_render_pass(wlr_output, state, NULL);
+
+    if(!pass){
+        wlr_texture_destroy(texture);
+        return false;
+    }
+
+    struct wlr_render_texture_options options = {};
+    options.texture = texture;
+    options.dst_box = {0, 0, wlr_output->width, wlr_output->height};
+    options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+
+    wlr_render_pass_add_texture(pass, &options);
+
+    pixman_region32_t damage;
+    pixman_region32_init_rect(&damage, 0, 0, wlr_output->width, wlr_output->height);
+
+    wlr_output_add_software_cursors_to_render_pass(wlr_output, pass, &damage);
+    wlr_output_state_set_damage(state, &damage);
+
+    pixman_region32_fini(&damage);
+
+    bool ok = wlr_render_pass_submit(pass);
+
+    wlr_texture_destroy(texture);
+
+    return ok;
+}
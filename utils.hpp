@@ -14,6 +14,9 @@ struct wlr_scene_node;
 struct wlr_layer_surface_v1;
 struct wlr_surface;
 struct wlr_box;
+struct wlr_buffer;
+struct wlr_output_state;
+struct timespec;
 
 namespace utils {
     std::tuple<yawc_toplevel*, yawc_input_on_surface>
@@ -29,6 +32,9 @@ namespace utils {
     bool toplevel_not_empty(struct yawc_toplevel* toplevel);
 
     struct yawc_output* get_output_of_toplevel(struct yawc_toplevel* toplevel);
+    struct yawc_output* output_at_cursor(struct yawc_server *server);
+
+    void update_output_occupants(struct yawc_server *server);
 
     bool pointer_pressed(struct wlr_pointer_button_event *event);
 
@@ -40,4 +46,10 @@ namespace utils {
     struct wlr_box get_usable_area_of_output(struct yawc_output *output);
 
     uint64_t hash_file_fnv1a(const std::string& path);
+
+    //stretches buffer over the whole output, software cursors included
+    bool blit_buffer_to_output(struct yawc_output *output, struct wlr_output_state *state, struct wlr_buffer *buffer);
+
+    int64_t timespec_to_ns(const struct timespec &ts);
+    int64_t now_ns();
 } // namespace utils
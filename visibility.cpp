@@ -0,0 +1,185 @@
+#include "visibility.hpp"
+
+#include "toplevel.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+
+void check_visible_buffer(struct wlr_scene_buffer *buffer, int sx, int sy, void *data){
+    //the scene only gives a primary output to buffers with a visible region on it
+    if(buffer->primary_output && wlr_scene_surface_try_from_buffer(buffer)){
+        *static_cast<bool*>(data) = true;
+    }
+}
+
+bool toplevel_visible(struct yawc_toplevel *toplevel){
+    if(!toplevel->scene_tree || toplevel->hidden || !toplevel->scene_tree->node.enabled){
+        return false;
+    }
+
+    bool visible = false;
+    wlr_scene_node_for_each_buffer(&toplevel->scene_tree->node, check_visible_buffer, &visible);
+
+    return visible;
+}
+
+void send_frame_done(struct wlr_surface *surface, int sx, int sy, void *data){
+    wlr_surface_send_frame_done(surface, static_cast<struct timespec*>(data));
+}
+
+int hidden_frame_interval_ms(struct yawc_server *server){
+    return std::max(1, 1000 / server->config->performance.hidden_frame_rate);
+}
+
+void visibility_update(struct yawc_server *server){
+    bool any_suspended = false;
+
+    struct yawc_toplevel *toplevel;
+    wl_list_for_each(toplevel, &server->toplevels, link){
+        if(!toplevel->mapped){
+            continue;
+        }
+
+        bool suspended = !toplevel_visible(toplevel);
+
+        if(suspended != toplevel->suspended){
+            toplevel->suspended = suspended;
+            toplevel->last_hidden_frame_ns = 0;
+
+            wlr_xdg_toplevel_set_suspended(toplevel->xdg_toplevel, suspended);
+        }
+
+        any_suspended |= suspended;
+    }
+
+    //visible ones are served by the scene at the output rate, the timer is only for hidden ones
+    bool wanted = any_suspended && server->config->performance.hidden_frame_rate > 0;
+
+    if(wanted != server->visibility_timer_armed){
+        server->visibility_timer_armed = wanted;
+        wl_event_source_timer_update(server->visibility_timer, wanted ? hidden_frame_interval_ms(server) : 0);
+    }
+}
+
+int handle_visibility_timer(void *data){
+    struct yawc_server *server = static_cast<struct yawc_server*>(data);
+    int32_t rate = server->config->performance.hidden_frame_rate;
+
+    server->visibility_timer_armed = false;
+
+    if(rate <= 0){
+        return 0;
+    }
+
+    int64_t now_ns = utils::now_ns();
+    int64_t interval_ns = 1000000000LL / rate;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    bool any_suspended = false;
+
+    struct yawc_toplevel *toplevel;
+    wl_list_for_each(toplevel, &server->toplevels, link){
+        if(!toplevel->mapped || !toplevel->suspended){
+            continue;
+        }
+
+        any_suspended = true;
+
+        if(now_ns - toplevel->last_hidden_frame_ns < interval_ns){
+            continue;
+        }
+
+        toplevel->last_hidden_frame_ns = now_ns;
+
+        wlr_xdg_surface_for_each_surface(toplevel->xdg_toplevel->base, send_frame_done, &now);
+    }
+
+    if(any_suspended){
+        server->visibility_timer_armed = true;
+        wl_event_source_timer_update(server->visibility_timer, hidden_frame_interval_ms(server));
+    }
+
+    return 0;
+}
+
+void handle_visibility_idle(void *data){
+    struct yawc_server *server = static_cast<struct yawc_server*>(data);
+
+    server->visibility_idle = nullptr;
+
+    visibility_update(server);
+}
+
+//a scene update touches many buffers, look at them once it's done
+void handle_surface_outputs_update(struct wl_listener *listener, void *data){
+    struct yawc_toplevel *toplevel = wl_container_of(listener, toplevel, surface_outputs_update);
+    auto *server = toplevel->server;
+
+    if(!server->visibility_idle){
+        server->visibility_idle = wl_event_loop_add_idle(server->wl_event_loop, handle_visibility_idle, server);
+    }
+}
+
+void handle_surface_buffer_destroy(struct wl_listener *listener, void *data){
+    struct yawc_toplevel *toplevel = wl_container_of(listener, toplevel, surface_buffer_destroy);
+
+    visibility_untrack_toplevel(toplevel);
+}
+
+void find_surface_buffer(struct wlr_scene_buffer *buffer, int sx, int sy, void *data){
+    auto *toplevel = static_cast<struct yawc_toplevel*>(data);
+    auto *scene_surface = wlr_scene_surface_try_from_buffer(buffer);
+
+    if(!toplevel->surface_buffer && scene_surface && scene_surface->surface == toplevel->xdg_toplevel->base->surface){
+        toplevel->surface_buffer = buffer;
+    }
+}
+
+void visibility_track_toplevel(struct yawc_toplevel *toplevel){
+    if(toplevel->surface_buffer || !toplevel->scene_tree){
+        return;
+    }
+
+    wlr_scene_node_for_each_buffer(&toplevel->scene_tree->node, find_surface_buffer, toplevel);
+
+    if(!toplevel->surface_buffer){
+        return;
+    }
+
+    toplevel->surface_outputs_update.notify = handle_surface_outputs_update;
+    wl_signal_add(&toplevel->surface_buffer->events.outputs_update, &toplevel->surface_outputs_update);
+
+    toplevel->surface_buffer_destroy.notify = handle_surface_buffer_destroy;
+    wl_signal_add(&toplevel->surface_buffer->node.events.destroy, &toplevel->surface_buffer_destroy);
+}
+
+void visibility_untrack_toplevel(struct yawc_toplevel *toplevel){
+    if(!toplevel->surface_buffer){
+        return;
+    }
+
+    wl_list_remove(&toplevel->surface_outputs_update.link);
+    wl_list_remove(&toplevel->surface_buffer_destroy.link);
+
+    toplevel->surface_buffer = nullptr;
+}
+
+void visibility_init(struct yawc_server *server){
+    server->visibility_timer = wl_event_loop_add_timer(server->wl_event_loop, handle_visibility_timer, server);
+}
+
+void visibility_finish(struct yawc_server *server){
+    if(server->visibility_idle){
+        wl_event_source_remove(server->visibility_idle);
+        server->visibility_idle = nullptr;
+    }
+
+    if(server->visibility_timer){
+        wl_event_source_remove(server->visibility_timer);
+        server->visibility_timer = nullptr;
+    }
+
+    server->visibility_timer_armed = false;
+}
@@ -0,0 +1,13 @@
+struct yawc_server;
+
+struct yawc_toplevel;
+
+void visibility_init(struct yawc_server *server);
+void visibility_finish(struct yawc_server *server);
+
+//the scene tells us when the main surface changes outputs, no polling
+void visibility_track_toplevel(struct yawc_toplevel *toplevel);
+void visibility_untrack_toplevel(struct yawc_toplevel *toplevel);
+
+//suspends toplevels nobody can see and resumes the ones that came back
+void visibility_update(struct yawc_server *server);
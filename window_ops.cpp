@@ -4,7 +4,9 @@
 
 #include "utils.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 
 void begin_move(yawc_toplevel *toplevel)
 {
@@ -67,13 +69,16 @@ void yawc_toplevel::set_fullscreen(bool enable){
                                   chosen_output->wlr_output, &output_box);
 
         wlr_scene_node_set_position(&this->scene_tree->node, output_box.x, output_box.y);
+        hit_index_update(this->server, &this->scene_tree->node);
         wlr_xdg_toplevel_set_size(this->xdg_toplevel, output_box.width, output_box.height);
 
         wlr_scene_node_reparent(&this->scene_tree->node, this->server->layers.fullscreen);
+        hit_index_update(this->server, &this->scene_tree->node);
 
         this->fullscreen = true;
     } else {
         wlr_scene_node_reparent(&this->scene_tree->node, this->server->layers.normal);
+        hit_index_update(this->server, &this->scene_tree->node);
 
         this->reset_state();
 
@@ -87,6 +92,8 @@ void yawc_toplevel::set_fullscreen(bool enable){
     }
 
     this->send_geometry_update();
+
+    utils::update_output_occupants(this->server);
 }
 
 void yawc_toplevel::default_set_maximized(bool enable){
@@ -103,6 +110,7 @@ void yawc_toplevel::default_set_maximized(bool enable){
 
     if(enable){
         wlr_scene_node_set_position(&this->scene_tree->node, usable_box.x, usable_box.y);
+        hit_index_update(this->server, &this->scene_tree->node);
         wlr_xdg_toplevel_set_size(this->xdg_toplevel, usable_box.width, usable_box.height);
 
         return;
@@ -121,10 +129,12 @@ void yawc_toplevel::default_set_maximized(bool enable){
     int new_y = this->server->cursor->y;
 
     wlr_scene_node_set_position(&this->scene_tree->node, new_x, new_y);
+    hit_index_update(this->server, &this->scene_tree->node);
 }
 
 void yawc_toplevel::default_set_minimized(bool enable){
     wlr_scene_node_set_enabled(&this->scene_tree->node, !enable);
+    hit_index_update(this->server, &this->scene_tree->node);
 
     if(this->foreign_handle){
         wlr_foreign_toplevel_handle_v1_set_minimized(this->foreign_handle, enable);
@@ -147,5 +157,86 @@ void yawc_toplevel::default_set_minimized(bool enable){
     }
 
     this->hidden = enable;
+
+    utils::update_output_occupants(this->server);
+}
+
+//clients that never ack don't get to freeze the resize
+constexpr int64_t RESIZE_ACK_TIMEOUT_NS = 500'000'000;
+
+//a client that never acks can't grow the moves forever
+constexpr size_t RESIZE_MAX_MOVES = 16;
+
+void yawc_toplevel::interactive_resize(int x, int y, int width, int height){
+    this->resize.x = x;
+    this->resize.y = y;
+    this->resize.pending_move = true;
+
+    this->interactive_resize(width, height);
+}
+
+void yawc_toplevel::interactive_resize(int width, int height){
+    this->resize.width = width;
+    this->resize.height = height;
+    this->resize.pending = true;
+
+    if(this->server->config->performance.resize_configure_per_frame){
+        //sent from the next frame of its output
+        if(auto *output = utils::get_output_of_toplevel(this)){
+            wlr_output_schedule_frame(output->wlr_output);
+        }
+
+        return;
+    }
+
+    if(!this->resize_in_flight()){
+        this->flush_interactive_resize();
+    }
+}
+
+bool yawc_toplevel::resize_in_flight(){
+    return this->resize.serial && utils::now_ns() - this->resize.sent_ns < RESIZE_ACK_TIMEOUT_NS;
+}
+
+void yawc_toplevel::flush_interactive_resize(){
+    if(!this->resize.pending){
+        return;
+    }
+
+    this->resize.pending = false;
+
+    this->resize.serial = wlr_xdg_toplevel_set_size(this->xdg_toplevel, this->resize.width, this->resize.height);
+    this->resize.sent_ns = utils::now_ns();
+
+    if(this->resize.pending_move){
+        this->resize.pending_move = false;
+
+        if(this->resize.moves.size() >= RESIZE_MAX_MOVES){
+            this->resize.moves.erase(this->resize.moves.begin());
+        }
+
+        this->resize.moves.push_back({this->resize.serial, this->resize.x, this->resize.y});
+    }
+}
+
+void yawc_toplevel::apply_resize_moves(){
+    uint32_t committed = this->xdg_toplevel->base->current.configure_serial;
+
+    auto done = std::find_if(this->resize.moves.begin(), this->resize.moves.end(), [committed](auto &move){
+        return (int32_t)(committed - move.serial) < 0;
+    });
+
+    if(done == this->resize.moves.begin()){
+        return;
+    }
+
+    //the newest configure this commit caught up with
+    auto &move = *std::prev(done);
+    struct wlr_box geo = this->xdg_toplevel->base->geometry;
+
+    wlr_scene_node_set_position(&this->scene_tree->node, move.x - geo.x, move.y - geo.y);
+    hit_index_update(this->server, &this->scene_tree->node);
+
+    this->resize.moves.erase(this->resize.moves.begin(), done);
 }
 
@@ -31,8 +31,7 @@ void reload_toplevels(struct yawc_server *sv){
         //in case the wm messes with the order ( with focus_toplevel )
         //we need to keep a snapshot list
         for(auto el: existing_toplevels){
-            wm_toplevel topl{el};
-            wm->callbacks.on_map(&topl); 
+            wm->callbacks.on_map(wm_toplevel_handle(el)); 
         }
     }
 }
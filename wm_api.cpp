@@ -5,6 +5,7 @@
 #include "wm_api.h"
 #include "wm_defs.hpp"
 #include "window_ops.hpp"
+#include "cursor_image.hpp"
 
 yawc_server *wm_server;
 
@@ -17,7 +18,7 @@ WM_API void wm_plugin_log(const char *fmt, ...) {
 }
 
 WM_API void wm_focus_toplevel(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -25,23 +26,25 @@ WM_API void wm_focus_toplevel(wm_toplevel *t){
 }
 
 WM_API void wm_raise_toplevel(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
     wlr_scene_node_raise_to_top(&t->toplevel->scene_tree->node);
+    hit_index_update(wm_server, &t->toplevel->scene_tree->node);
 }
 
 WM_API void wm_lower_toplevel(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
     wlr_scene_node_lower_to_bottom(&t->toplevel->scene_tree->node);
+    hit_index_update(wm_server, &t->toplevel->scene_tree->node);
 }
 
 WM_API wm_id_t wm_toplevel_get_id(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return -1;
     }
 
@@ -169,10 +172,7 @@ WM_API int wm_get_amount_of_toplevels(){
 WM_API void wm_foreach_toplevel(wm_toplevel_iter_cb cb, void *user) {
     struct yawc_toplevel *toplevel;
     wl_list_for_each(toplevel, &wm_server->toplevels, link){
-        wm_toplevel fnin;
-        fnin.toplevel = toplevel;
-
-        cb(&fnin, user);
+        cb(wm_toplevel_handle(toplevel), user);
     }
 }
 
@@ -185,7 +185,7 @@ WM_API float wm_get_output_render_scale(wm_output *output){
 }
 
 WM_API void wm_begin_move(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -193,7 +193,7 @@ WM_API void wm_begin_move(wm_toplevel *t) {
 }
 
 WM_API void wm_begin_resize(wm_toplevel *t, uint32_t edge_bits){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -201,7 +201,7 @@ WM_API void wm_begin_resize(wm_toplevel *t, uint32_t edge_bits){
 }
 
 WM_API void wm_set_cursor(const char* name){
-    wlr_cursor_set_xcursor(wm_server->cursor, wm_server->cursor_mgr, name);
+    cursor_set_image(wm_server, name);
 }
 
 WM_API const char *wm_get_cursor_name_from_edges(uint32_t bits){
@@ -213,29 +213,31 @@ WM_API void wm_cancel_window_op() {
 }
 
 WM_API void wm_set_toplevel_position(wm_toplevel *t, int x, int y) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
     yawc_toplevel *toplevel = t->toplevel;
 
     wlr_scene_node_set_position(&toplevel->scene_tree->node, x, y);
+    hit_index_update(wm_server, &toplevel->scene_tree->node);
 }
 
 WM_API void wm_set_toplevel_geometry(wm_toplevel *t, wm_box_t geo) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
     yawc_toplevel *toplevel = t->toplevel;
 
     wlr_scene_node_set_position(&toplevel->scene_tree->node, geo.x, geo.y);
+    hit_index_update(wm_server, &toplevel->scene_tree->node);
 
     wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, geo.width, geo.height);
 }
 
 WM_API wm_box_t wm_restore_toplevel_geometry(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return {};
     }
 
@@ -256,8 +258,25 @@ WM_API void wm_unref_output(wm_output *o){
     delete o;
 }
 
+WM_API wm_toplevel *wm_ref_toplevel(wm_toplevel *t){
+    if(!t){
+        return nullptr;
+    }
+
+    t->refs++;
+
+    return t;
+}
+
 WM_API void wm_unref_toplevel(wm_toplevel *t){
-    delete t;
+    //borrowed handles (callback arguments) have nothing to drop
+    if(!t || !t->refs){
+        return;
+    }
+
+    t->refs--;
+
+    wm_recycle_toplevel_slot(t);
 }
 
 //X impl
@@ -341,7 +360,7 @@ WM_API const char *wm_get_toplevel_title(wm_toplevel *t){
 }
 
 WM_API uint64_t wm_get_toplevel_id(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return -1;
     }
 
@@ -349,13 +368,16 @@ WM_API uint64_t wm_get_toplevel_id(wm_toplevel *t){
 }
 
 WM_API void wm_hide_toplevel(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
     yawc_toplevel *toplevel = t->toplevel;
 
     wlr_scene_node_set_enabled(&toplevel->scene_tree->node, false);
+    hit_index_update(wm_server, &toplevel->scene_tree->node);
+
+    utils::update_output_occupants(wm_server);
 
     if(toplevel->foreign_handle){
         wlr_foreign_toplevel_handle_v1_set_minimized(toplevel->foreign_handle, true);
@@ -380,7 +402,7 @@ WM_API void wm_hide_toplevel(wm_toplevel *t) {
 }
 
 WM_API void wm_unhide_toplevel(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -388,14 +410,17 @@ WM_API void wm_unhide_toplevel(wm_toplevel *t) {
 
     if(t->toplevel->hidden){
         wlr_scene_node_set_enabled(&toplevel->scene_tree->node, true);
+        hit_index_update(wm_server, &toplevel->scene_tree->node);
         wlr_foreign_toplevel_handle_v1_set_minimized(toplevel->foreign_handle, false);
 
         t->toplevel->hidden = false;
+
+        utils::update_output_occupants(wm_server);
     }
 }
 
 WM_API void wm_close_toplevel(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -459,6 +484,7 @@ void update_toplevel_resize_grip(
         needs_destroying |= grip.type == WM_GRIP_VISUAL_NONE;
 
         if(needs_destroying){
+            hit_index_update(wm_server, *node);
             wlr_scene_node_destroy(*node); 
             *node = create_grip_for_toplevel(grip, ytoplevel, width, height, bits);
         } else if (grip.type == WM_GRIP_VISUAL_COLOR) {
@@ -477,6 +503,8 @@ void update_toplevel_resize_grip(
 
     wlr_scene_node_set_position(*node, x, y);
     wlr_scene_node_raise_to_top(*node);
+
+    hit_index_update(wm_server, *node);
 }
 
 WM_API void wm_configure_toplevel_resize_grips(
@@ -486,7 +514,7 @@ WM_API void wm_configure_toplevel_resize_grips(
     int grip_thickness, 
     wm_grip_render_cb render_cb,
     void *user_data){
-    if (!t) {
+    if (!t || !t->toplevel) {
         return;
     }
 
@@ -610,7 +638,7 @@ WM_API wm_output *wm_get_focused_output() {
 }
 
 WM_API wm_output *wm_get_output_of_toplevel(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return nullptr;
     }
 
@@ -626,7 +654,7 @@ WM_API wm_output *wm_get_output_of_toplevel(wm_toplevel *t) {
 WM_API wm_box_t wm_get_toplevel_geometry(wm_toplevel *t) {
     wm_box_t box = {0};
 
-    if(!t){
+    if(!t || !t->toplevel){
         return box;
     }
 
@@ -657,7 +685,7 @@ WM_API wm_box_t wm_get_output_usable_area(wm_output *o) {
 }
 
 WM_API void wm_set_toplevel_fullscreen(wm_toplevel *t, bool f){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -667,7 +695,7 @@ WM_API void wm_set_toplevel_fullscreen(wm_toplevel *t, bool f){
 }
 
 WM_API void wm_set_toplevel_maximized(wm_toplevel *t, bool m){
-    if(!t){
+    if(!t || !t->toplevel){
         return;
     }
 
@@ -681,7 +709,7 @@ WM_API void wm_set_toplevel_maximized(wm_toplevel *t, bool m){
 }
 
 WM_API bool wm_toplevel_is_fullscreen(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return false;
     }
 
@@ -689,7 +717,7 @@ WM_API bool wm_toplevel_is_fullscreen(wm_toplevel *t){
 }
 
 WM_API bool wm_toplevel_is_maximized(wm_toplevel *t) {
-    if(!t){
+    if(!t || !t->toplevel){
         return false;
     }
 
@@ -698,7 +726,7 @@ WM_API bool wm_toplevel_is_maximized(wm_toplevel *t) {
 
 
 WM_API bool wm_toplevel_is_hidden(wm_toplevel *t){
-    if(!t){
+    if(!t || !t->toplevel){
         return false;
     }
 
@@ -843,10 +871,15 @@ WM_API wm_buffer *wm_attach_overlay(const char *name, wm_buffer *buffer, int x,
 
     wlr_scene_buffer_set_dest_size(scene_buffer, buffer->box.width, buffer->box.height);
 
+    hit_index_update(wm_server, &scene_buffer->node);
+
     scene_buffer->node.data = buffer;
 
     overlays[name] = scene_buffer;
 
+    damage_debug_attribute(wm_server, std::string{"wm:"} + name, 
+        {x, y, buffer->box.width, buffer->box.height});
+
     return old_buffer;
 }
 
@@ -875,6 +908,10 @@ WM_API wm_buffer *wm_toplevel_attach_buffer(wm_toplevel *toplevel, const char *n
     wm_buffer *old_buffer = nullptr;
     struct wlr_scene_buffer *cur_scene_buf;
 
+    if(!toplevel || !toplevel->toplevel){
+        return nullptr;
+    }
+
     auto ytoplevel = toplevel->toplevel;
 
     auto& buffers = ytoplevel->buffers;
@@ -895,16 +932,28 @@ WM_API wm_buffer *wm_toplevel_attach_buffer(wm_toplevel *toplevel, const char *n
 
     wlr_scene_buffer_set_dest_size(cur_scene_buf, buffer->box.width, buffer->box.height);
 
+    hit_index_update(wm_server, &cur_scene_buf->node);
+
     cur_scene_buf->node.data = buffer;
 
     buffer->toplevel = toplevel->toplevel;
 
     buffers[name] = cur_scene_buf;
 
+    int lx, ly;
+    wlr_scene_node_coords(&cur_scene_buf->node, &lx, &ly);
+
+    damage_debug_attribute(wm_server, std::string{"wm:"} + name, 
+        {lx, ly, buffer->box.width, buffer->box.height});
+
     return old_buffer;
 }
 
 WM_API wm_buffer *wm_toplevel_unattach_buffer(wm_toplevel *toplevel, const char *name) {
+    if(!toplevel || !toplevel->toplevel){
+        return nullptr;
+    }
+
     auto &buffers = toplevel->toplevel->buffers;
 
   	auto it = buffers.find(name);
@@ -915,6 +964,7 @@ WM_API wm_buffer *wm_toplevel_unattach_buffer(wm_toplevel *toplevel, const char
 
     wm_buffer *buf = static_cast<wm_buffer*>(it->second->node.data);
 
+    hit_index_update(wm_server, &it->second->node);
     wlr_scene_node_destroy(&it->second->node);
 
     buffers.erase(it);
@@ -959,7 +1009,7 @@ WM_API bool wm_render_fn_to_buffer(wm_buffer *buffer, wm_render_cb cb, void *use
 }
 
 WM_API void wm_toplevel_attach_state(wm_toplevel *toplevel, void *data){
-    if(!toplevel){
+    if(!toplevel || !toplevel->toplevel){
         return;
     }
 
@@ -967,7 +1017,7 @@ WM_API void wm_toplevel_attach_state(wm_toplevel *toplevel, void *data){
 }
 
 WM_API void *wm_get_toplevel_state(wm_toplevel *toplevel){
-    if(!toplevel){
+    if(!toplevel || !toplevel->toplevel){
         return nullptr;
     }
 
@@ -995,7 +1045,7 @@ WM_API wm_toplevel* wm_get_next_toplevel(struct wm_toplevel *cur){
         return nullptr;
     }
 
-    if(!cur){
+    if(!cur || !cur->toplevel){
         yawc_toplevel *toplevel;
 
         auto *out_toplevel = wl_container_of(list_head->prev, toplevel, link);
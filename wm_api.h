@@ -117,6 +117,13 @@ typedef struct {
 
     wm_button_t button; 
     bool pressed;
+
+    // what's under the pointer, same as wm_try_get_node_at_coords(global_x, global_y)
+    wm_node node;
+    wm_node_coords_t coords;
+
+    wm_toplevel *toplevel; // window owning node (surface or resize grip), owned by the event
+    uint32_t resize_edges; // WM_RESIZE_EDGE_INVALID unless node is a resize grip
 } wm_pointer_event_t;
 
 typedef struct {
@@ -167,7 +174,11 @@ WM_API void wm_foreach_toplevel(wm_toplevel_iter_cb cb, void *user);
 WM_API wm_toplevel **wm_get_toplevels(size_t *size); 
 WM_API void wm_unref_toplevels(wm_toplevel **t, size_t amnt);
 
+//a toplevel has one handle for its whole life. getters return it with a reference taken, drop it with wm_unref_toplevel.
+//handles passed to callbacks are borrowed, only valid during the call. to store one, wm_ref_toplevel it first:
+//a referenced handle outlives its toplevel (every call ignores it once the toplevel is destroyed) and is never reused
 WM_API wm_toplevel *wm_get_focused_toplevel(void);
+WM_API wm_toplevel *wm_ref_toplevel(wm_toplevel *);
 WM_API void wm_unref_toplevel(wm_toplevel *);
 
 WM_API wm_node_coords_t wm_try_get_node_at_coords(wm_node *node, double x, double y);
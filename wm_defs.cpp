@@ -2,16 +2,62 @@
 #include "wm_api.h"
 #include "wm_defs.hpp"
 
+#include <deque>
+#include <vector>
+
 wm_keyboard_event_t wm_create_empty_keyboard_event(){
         return wm_keyboard_event_t {};
 }
 
+std::deque<wm_toplevel> toplevel_slots; // deque so slots never move
+std::vector<wm_toplevel*> free_toplevel_slots;
+
+wm_toplevel *wm_toplevel_handle(yawc_toplevel *toplevel){
+        if(!toplevel->wm_handle){
+                wm_toplevel *slot;
+
+                if(free_toplevel_slots.empty()){
+                        slot = &toplevel_slots.emplace_back();
+                } else{
+                        slot = free_toplevel_slots.back();
+                        free_toplevel_slots.pop_back();
+                }
+
+                slot->toplevel = toplevel;
+                slot->refs = 0;
+
+                toplevel->wm_handle = slot;
+        }
+
+        return toplevel->wm_handle;
+}
+
 wm_toplevel *wm_create_toplevel(yawc_toplevel *backer){
-        auto *tp = new wm_toplevel;
-        tp->toplevel = backer;
+        auto *tp = wm_toplevel_handle(backer);
+        tp->refs++;
         return tp;
 }
 
+void wm_recycle_toplevel_slot(wm_toplevel *slot){
+        if(!slot->toplevel && !slot->refs){
+                free_toplevel_slots.push_back(slot);
+        }
+}
+
+void wm_release_toplevel_handle(yawc_toplevel *toplevel){
+        auto *slot = toplevel->wm_handle;
+
+        if(!slot){
+                return;
+        }
+
+        //handles the wm still holds see a dead toplevel from now on
+        slot->toplevel = nullptr;
+        toplevel->wm_handle = nullptr;
+
+        wm_recycle_toplevel_slot(slot);
+}
+
 wm_pointer_event_t wm_create_pointer_event(yawc_server *sv, yawc_mouse_operation op, uint32_t button, bool pressed){
         auto evt {wm_pointer_event_t{}};
 
@@ -23,6 +69,28 @@ wm_pointer_event_t wm_create_pointer_event(yawc_server *sv, yawc_mouse_operation
 
         evt.op = (wm_mouse_operation)op;
 
+        evt.resize_edges = WM_RESIZE_EDGE_INVALID;
+
+        //resolved once here, the wm asking again for the same point gets the cached hit
+        const struct yawc_hit_result *hit = hit_index_resolve(sv, evt.global_x, evt.global_y);
+
+        if(!hit->node){
+                return evt;
+        }
+
+        evt.node = wm_node{hit->node};
+
+        evt.coords.global_x = evt.global_x;
+        evt.coords.global_y = evt.global_y;
+        evt.coords.local_x = hit->sx;
+        evt.coords.local_y = hit->sy;
+
+        if(hit->toplevel){
+                evt.toplevel = wm_create_toplevel(hit->toplevel);
+        }
+
+        evt.resize_edges = hit->grip_edges;
+
         return evt;
 }
 
@@ -36,7 +104,13 @@ wm_toplevel_request_event_t wm_create_toplevel_request_event(wm_toplevel *toplev
         return evt;
 }
 
-void wm_destroy_pointer_event(wm_pointer_event_t *ev){}
+void wm_destroy_pointer_event(wm_pointer_event_t *ev){
+    if(!ev){
+        return;
+    }
+
+    wm_unref_toplevel(ev->toplevel);
+}
 void wm_destroy_keyboard_event(wm_keyboard_event_t *ev){}
 
 void wm_destroy_toplevel_request_event(wm_toplevel_request_event_t *ev){
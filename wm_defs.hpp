@@ -2,8 +2,11 @@
 #include "layer.hpp"
 #include "wm_api.h"
 
+//handles come from a slab, a toplevel keeps the same one for its whole life.
+//a slot is only reused once its toplevel is gone and every wm_create_toplevel was unref'd
 typedef struct wm_toplevel {
-    yawc_toplevel *toplevel;
+    yawc_toplevel *toplevel; // nullptr once the toplevel is destroyed
+    uint32_t refs;
 } wm_toplevel;
 
 typedef struct wm_output {
@@ -27,7 +30,10 @@ wm_keyboard_event_t wm_create_empty_keyboard_event();
 
 wm_pointer_event_t wm_create_pointer_event(yawc_server *, yawc_mouse_operation, uint32_t button, bool pressed);
 wm_toplevel_request_event_t wm_create_toplevel_request_event(wm_toplevel *toplevel, wm_toplevel_request_type_t type, void *data);
-wm_toplevel *wm_create_toplevel(yawc_toplevel *toplevel);
+wm_toplevel *wm_create_toplevel(yawc_toplevel *toplevel); // takes a reference, no allocation
+wm_toplevel *wm_toplevel_handle(yawc_toplevel *toplevel); // borrowed, for callback arguments
+void wm_release_toplevel_handle(yawc_toplevel *toplevel);
+void wm_recycle_toplevel_slot(wm_toplevel *slot);
 
 void wm_destroy_pointer_event(wm_pointer_event_t *ev);
 void wm_destroy_keyboard_event(wm_keyboard_event_t *ev);
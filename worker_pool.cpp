@@ -0,0 +1,157 @@
+#include "worker_pool.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <wayland-server-core.h>
+#include <wlr/util/log.h>
+
+void worker_main(struct yawc_worker_pool *pool){
+    while(true){
+        yawc_worker_job job;
+
+        {
+            std::unique_lock guard(pool->lock);
+            pool->wake.wait(guard, [pool]{ return pool->stopping || !pool->queue.empty(); });
+
+            if(pool->queue.empty()){
+                return; // stopping and nothing left
+            }
+
+            job = std::move(pool->queue.front());
+            pool->queue.pop_front();
+        }
+
+        job.run();
+
+        if(!job.done){
+            continue;
+        }
+
+        {
+            std::lock_guard guard(pool->lock);
+            pool->completed.push_back(std::move(job.done));
+        }
+
+        uint64_t one = 1;
+
+        //EAGAIN means the counter is saturated, the loop is woken anyway
+        while(write(pool->event_fd, &one, sizeof(one)) < 0 && errno == EINTR);
+    }
+}
+
+int handle_worker_completions(int fd, uint32_t mask, void *data){
+    struct yawc_worker_pool *pool = static_cast<struct yawc_worker_pool*>(data);
+
+    uint64_t count;
+
+    if(read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN && errno != EINTR){
+        wlr_log_errno(WLR_ERROR, "Failed to read the worker eventfd");
+    }
+
+    std::vector<std::function<void()>> completed;
+
+    {
+        std::lock_guard guard(pool->lock);
+        completed.swap(pool->completed);
+    }
+
+    for(auto &done: completed){
+        done();
+    }
+
+    return 0;
+}
+
+bool worker_pool_init(struct yawc_worker_pool *pool, struct wl_event_loop *loop, size_t thread_count){
+    pool->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if(pool->event_fd < 0){
+        return false;
+    }
+
+    pool->event = wl_event_loop_add_fd(loop, pool->event_fd, WL_EVENT_READABLE, handle_worker_completions, pool);
+
+    if(!pool->event){
+        close(pool->event_fd);
+        pool->event_fd = -1;
+        return false;
+    }
+
+    //workers must never take signals meant for the event loop
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    bool started = true;
+
+    try{
+        for(size_t i = 0; i < thread_count; ++i){
+            pool->threads.emplace_back(worker_main, pool);
+        }
+    } catch(const std::system_error &e){
+        wlr_log(WLR_ERROR, "Failed to start a worker thread: %s", e.what());
+        started = false;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+
+    if(!started){
+        //joins the ones that did start, submit then runs inline
+        worker_pool_finish(pool);
+        return false;
+    }
+
+    return true;
+}
+
+void worker_pool_finish(struct yawc_worker_pool *pool){
+    {
+        std::lock_guard guard(pool->lock);
+        pool->stopping = true;
+    }
+
+    pool->wake.notify_all();
+
+    //queued jobs still run, their completions are dropped
+    for(auto &thread: pool->threads){
+        thread.join();
+    }
+
+    pool->threads.clear();
+    pool->completed.clear();
+
+    if(pool->event){
+        wl_event_source_remove(pool->event);
+        pool->event = nullptr;
+    }
+
+    if(pool->event_fd >= 0){
+        close(pool->event_fd);
+        pool->event_fd = -1;
+    }
+}
+
+void worker_pool_submit(struct yawc_worker_pool *pool, std::function<void()> run, std::function<void()> done){
+    //no workers, do it inline so callers don't need a fallback
+    if(pool->threads.empty()){
+        run();
+
+        if(done){
+            done();
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard guard(pool->lock);
+        pool->queue.push_back({std::move(run), std::move(done)});
+    }
+
+    pool->wake.notify_one();
+}
@@ -0,0 +1,34 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct wl_event_loop;
+struct wl_event_source;
+
+//jobs run on the workers, their completions run back on the event loop thread
+struct yawc_worker_job {
+    std::function<void()> run;
+    std::function<void()> done;
+};
+
+struct yawc_worker_pool {
+    std::vector<std::thread> threads;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<yawc_worker_job> queue;
+    std::vector<std::function<void()>> completed;
+
+    int event_fd = -1;
+    struct wl_event_source *event = nullptr;
+
+    bool stopping = false;
+};
+
+bool worker_pool_init(struct yawc_worker_pool *pool, struct wl_event_loop *loop, size_t thread_count);
+void worker_pool_finish(struct yawc_worker_pool *pool);
+
+void worker_pool_submit(struct yawc_worker_pool *pool, std::function<void()> run, std::function<void()> done = nullptr);